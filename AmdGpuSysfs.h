@@ -0,0 +1,252 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <dirent.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+
+// Views over amdgpu's binary gpu_metrics table (kgd_pp_interface.h). The kernel
+// structs are naturally aligned, so these prefixes match byte-for-byte; only the
+// fields we report are declared and newer content revisions append after them.
+struct AmdMetricsHeader {
+    uint16_t structure_size;
+    uint8_t format_revision;
+    uint8_t content_revision;
+};
+
+// gpu_metrics_v1_0: dGPU, temperatures in C, power in W.
+struct AmdGpuMetricsV1_0 {
+    AmdMetricsHeader header;
+    uint64_t system_clock_counter;
+    uint16_t temperature_edge;
+    uint16_t temperature_hotspot;
+    uint16_t temperature_mem;
+    uint16_t temperature_vrgfx;
+    uint16_t temperature_vrsoc;
+    uint16_t temperature_vrmem;
+    uint16_t average_gfx_activity;
+    uint16_t average_umc_activity;
+    uint16_t average_mm_activity;
+    uint16_t average_socket_power;
+    uint32_t energy_accumulator;
+    uint16_t average_gfxclk_frequency;
+    uint16_t average_socclk_frequency;
+    uint16_t average_uclk_frequency;
+    uint16_t average_vclk0_frequency;
+    uint16_t average_dclk0_frequency;
+    uint16_t average_vclk1_frequency;
+    uint16_t average_dclk1_frequency;
+    uint16_t current_gfxclk;
+    uint16_t current_socclk;
+    uint16_t current_uclk;
+    uint16_t current_vclk0;
+    uint16_t current_dclk0;
+    uint16_t current_vclk1;
+    uint16_t current_dclk1;
+    uint32_t throttle_status;
+};
+
+// gpu_metrics_v1_1 .. v1_3: energy widened to 64 bit and moved ahead of the timestamp.
+struct AmdGpuMetricsV1_1 {
+    AmdMetricsHeader header;
+    uint16_t temperature_edge;
+    uint16_t temperature_hotspot;
+    uint16_t temperature_mem;
+    uint16_t temperature_vrgfx;
+    uint16_t temperature_vrsoc;
+    uint16_t temperature_vrmem;
+    uint16_t average_gfx_activity;
+    uint16_t average_umc_activity;
+    uint16_t average_mm_activity;
+    uint16_t average_socket_power;
+    uint64_t energy_accumulator;
+    uint64_t system_clock_counter;
+    uint16_t average_gfxclk_frequency;
+    uint16_t average_socclk_frequency;
+    uint16_t average_uclk_frequency;
+    uint16_t average_vclk0_frequency;
+    uint16_t average_dclk0_frequency;
+    uint16_t average_vclk1_frequency;
+    uint16_t average_dclk1_frequency;
+    uint16_t current_gfxclk;
+    uint16_t current_socclk;
+    uint16_t current_uclk;
+    uint16_t current_vclk0;
+    uint16_t current_dclk0;
+    uint16_t current_vclk1;
+    uint16_t current_dclk1;
+    uint32_t throttle_status;
+};
+
+// gpu_metrics_v2_0 .. v2_4: APUs, temperatures in centi-C, power in mW.
+struct AmdGpuMetricsV2_0 {
+    AmdMetricsHeader header;
+    uint64_t system_clock_counter;
+    uint16_t temperature_gfx;
+    uint16_t temperature_soc;
+    uint16_t temperature_core[8];
+    uint16_t temperature_l3[2];
+    uint16_t average_gfx_activity;
+    uint16_t average_mm_activity;
+    uint16_t average_socket_power;
+    uint16_t average_cpu_power;
+    uint16_t average_soc_power;
+    uint16_t average_gfx_power;
+    uint16_t average_core_power[8];
+    uint16_t average_gfxclk_frequency;
+    uint16_t average_socclk_frequency;
+    uint16_t average_uclk_frequency;
+    uint16_t average_fclk_frequency;
+    uint16_t average_vclk_frequency;
+    uint16_t average_dclk_frequency;
+    uint16_t current_gfxclk;
+    uint16_t current_socclk;
+    uint16_t current_uclk;
+    uint16_t current_fclk;
+    uint16_t current_vclk;
+    uint16_t current_dclk;
+    uint16_t current_coreclk[8];
+    uint16_t current_l3clk[2];
+    uint32_t throttle_status;
+};
+
+static const uint16_t AMD_METRICS_UNSUPPORTED = 0xFFFF;
+
+template <typename View>
+inline const View* AmdMetricsView(const ProcFile& f) {
+    if (f.Size() < sizeof(View)) return nullptr;
+    const AmdMetricsHeader* h = reinterpret_cast<const AmdMetricsHeader*>(f.Data());
+    if (h->structure_size < sizeof(View)) return nullptr;
+    return reinterpret_cast<const View*>(f.Data());
+}
+
+// Decodes one gpu_metrics blob in place. Returns false for table versions we
+// have no view for (v1_4 and later reorder the v1 layout), in which case the
+// caller falls back to the plain files.
+inline bool DecodeAmdGpuMetrics(const ProcFile& f, GpuDeviceStats& d) {
+    if (f.Size() < sizeof(AmdMetricsHeader)) return false;
+    const AmdMetricsHeader* h = reinterpret_cast<const AmdMetricsHeader*>(f.Data());
+
+    auto valid = [](uint16_t v) { return v != AMD_METRICS_UNSUPPORTED; };
+
+    if (h->format_revision == 1 && h->content_revision == 0) {
+        const AmdGpuMetricsV1_0* m = AmdMetricsView<AmdGpuMetricsV1_0>(f);
+        if (!m) return false;
+        if (valid(m->average_gfx_activity)) d.load = (float)m->average_gfx_activity;
+        if (valid(m->average_umc_activity)) d.mem_load = (float)m->average_umc_activity;
+        if (valid(m->temperature_edge)) d.temp = (float)m->temperature_edge;
+        if (valid(m->average_socket_power)) d.power_w = (float)m->average_socket_power;
+        if (valid(m->current_gfxclk)) d.sm_clock_mhz = (float)m->current_gfxclk;
+        if (valid(m->current_uclk)) d.mem_clock_mhz = (float)m->current_uclk;
+        d.throttle_reasons = m->throttle_status;
+    }
+    else if (h->format_revision == 1 && h->content_revision <= 3) {
+        const AmdGpuMetricsV1_1* m = AmdMetricsView<AmdGpuMetricsV1_1>(f);
+        if (!m) return false;
+        if (valid(m->average_gfx_activity)) d.load = (float)m->average_gfx_activity;
+        if (valid(m->average_umc_activity)) d.mem_load = (float)m->average_umc_activity;
+        if (valid(m->temperature_edge)) d.temp = (float)m->temperature_edge;
+        if (valid(m->average_socket_power)) d.power_w = (float)m->average_socket_power;
+        if (valid(m->current_gfxclk)) d.sm_clock_mhz = (float)m->current_gfxclk;
+        if (valid(m->current_uclk)) d.mem_clock_mhz = (float)m->current_uclk;
+        d.throttle_reasons = m->throttle_status;
+    }
+    else if (h->format_revision == 2) {
+        const AmdGpuMetricsV2_0* m = AmdMetricsView<AmdGpuMetricsV2_0>(f);
+        if (!m) return false;
+        if (valid(m->average_gfx_activity)) d.load = (float)m->average_gfx_activity;
+        if (valid(m->temperature_gfx)) d.temp = (float)m->temperature_gfx / 100.0f;
+        if (valid(m->average_socket_power)) d.power_w = (float)m->average_socket_power / 1000.0f;
+        if (valid(m->current_gfxclk)) d.sm_clock_mhz = (float)m->current_gfxclk;
+        if (valid(m->current_uclk)) d.mem_clock_mhz = (float)m->current_uclk;
+        d.throttle_reasons = m->throttle_status;
+    }
+    else {
+        return false;
+    }
+
+    d.load = std::min(d.load, 100.0f);
+    d.throttled = d.throttle_reasons != 0;
+    return true;
+}
+
+// Every amdgpu card under /sys/class/drm. Each tick costs one pread of the binary
+// metrics table plus one of mem_info_vram_used per card.
+class AmdGpus {
+private:
+    struct Card {
+        ProcFile metrics;
+        ProcFile busy;
+        ProcFile vramUsed;
+        ProcFile temp;
+        GpuDeviceStats info;
+    };
+    std::vector<Card> cards;
+
+public:
+    size_t Count() const { return cards.size(); }
+
+    bool Init() {
+        for (const std::string& name : ListDrmCards()) {
+            std::string dev = "/sys/class/drm/" + name + "/device";
+            // gpu_metrics alone is not proof: other drivers may grow a file of that name.
+            if (SysDriver(dev.c_str()) != "amdgpu") continue;
+            Card c;
+            // Tables we cannot decode (e.g. v1_4+ on MI300) fall back to busy percent + hwmon.
+            bool hasMetrics = c.metrics.Open((dev + "/gpu_metrics").c_str(), 1024) && c.metrics.Read() &&
+                DecodeAmdGpuMetrics(c.metrics, c.info);
+            if (!hasMetrics) {
+                c.metrics.Close();
+                if (!c.busy.Open((dev + "/gpu_busy_percent").c_str(), 64)) continue;
+            }
+
+            c.info = GpuDeviceStats();
+            c.info.index = (int)cards.size();
+            snprintf(c.info.name, sizeof(c.info.name), "%s (amdgpu)", name.c_str());
+
+            uint64_t vramTotal = 0;
+            if (ReadFileU64((dev + "/mem_info_vram_total").c_str(), vramTotal)) {
+                c.info.vram_total_gb = (float)vramTotal / (1024.f * 1024.f * 1024.f);
+            }
+            c.vramUsed.Open((dev + "/mem_info_vram_used").c_str(), 64);
+
+            if (!hasMetrics) {
+                if (DIR* hw = OpenSysDir((dev + "/hwmon").c_str())) {
+                    while (dirent* e = readdir(hw)) {
+                        if (strncmp(e->d_name, "hwmon", 5) != 0) continue;
+                        if (c.temp.Open((dev + "/hwmon/" + e->d_name + "/temp1_input").c_str(), 64)) break;
+                    }
+                    closedir(hw);
+                }
+            }
+            cards.push_back(std::move(c));
+        }
+        return !cards.empty();
+    }
+
+    void Sample(SensorSnapshot& snap) {
+        snap.gpus.resize(cards.size());
+
+        for (size_t i = 0; i < cards.size(); i++) {
+            Card& c = cards[i];
+            GpuDeviceStats& d = c.info;
+
+            if (!(c.metrics.IsOpen() && c.metrics.Read() && DecodeAmdGpuMetrics(c.metrics, d))) {
+                uint64_t v = 0;
+                if (c.busy.Read() && TextScanner(c.busy).U64(v)) d.load = (float)std::min<uint64_t>(v, 100);
+                if (c.temp.Read() && TextScanner(c.temp).U64(v)) d.temp = (float)v / 1000.0f;
+            }
+
+            uint64_t used = 0;
+            if (c.vramUsed.Read() && TextScanner(c.vramUsed).U64(used)) d.vram_used_gb = (float)used / (1024.f * 1024.f * 1024.f);
+
+            snap.gpus[i] = d;
+        }
+
+        AggregateGpus(snap);
+    }
+};
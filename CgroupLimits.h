@@ -0,0 +1,189 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+
+// Reads a cgroup v2 limit value; "max" (no limit) returns false.
+inline bool ParseCgroupLimit(TextScanner& s, uint64_t& value) {
+    s.SkipBlanks();
+    if (s.StartsWith("max", 3)) {
+        s.Consume("max", 3);
+        return false;
+    }
+    return s.U64(value);
+}
+
+// The unified-hierarchy path of this process ("0::/docker/abc..."), or false when
+// the process is not on cgroup v2.
+inline bool ReadSelfCgroup(std::string& path) {
+    ProcFile f;
+    if (!f.Open("/proc/self/cgroup", 1024) || !f.Read()) return false;
+    TextScanner s(f);
+    while (!s.AtEnd()) {
+        if (s.Consume("0::", 3)) {
+            const char* start = s.Pos();
+            s.SkipTo('\n');
+            path.assign(start, s.Pos());
+            return !path.empty() && path[0] == '/';
+        }
+        s.SkipLine();
+    }
+    return false;
+}
+
+// The widget's own cgroup v2 quota. The effective limit is the tightest one on the
+// path up to the hierarchy root, so memory.max / cpu.max are opened for every
+// ancestor and re-read every LIMIT_PERIOD ticks (limits change rarely, e.g. on
+// `docker update`); memory.current and cpu.stat are read every tick. When a
+// limit exists, the headline RAM / CPU figures are rescaled to it and the host
+// values are kept in snap.cgroup.
+class CgroupLimitProvider : public SensorProvider {
+private:
+    static const int LIMIT_PERIOD = 25;
+    static constexpr float BYTES_TO_GB = 1.0f / (1024.f * 1024.f * 1024.f);
+
+    enum Counter { CG_USAGE, CG_THROTTLED_USEC, CG_NR_PERIODS, CG_NR_THROTTLED, CG_COUNTER_COUNT };
+
+    std::string path;
+    ProcFile memoryCurrent;
+    ProcFile cpuStat;
+    std::vector<ProcFile> memoryMax;
+    std::vector<ProcFile> cpuMax;
+    RateStage rates;
+    int tick = 0;
+
+    bool memoryLimited = false;
+    uint64_t memoryLimit = 0;
+    bool cpuLimited = false;
+    float quotaCores = 0.0f;
+
+    void ReadLimits() {
+        memoryLimited = false;
+        memoryLimit = 0;
+        for (ProcFile& f : memoryMax) {
+            uint64_t v = 0;
+            if (!f.Read()) continue;
+            TextScanner s(f);
+            if (ParseCgroupLimit(s, v) && (!memoryLimited || v < memoryLimit)) {
+                memoryLimit = v;
+                memoryLimited = true;
+            }
+        }
+
+        // cpu.max: "$QUOTA $PERIOD" in microseconds, quota may be "max".
+        cpuLimited = false;
+        quotaCores = 0.0f;
+        for (ProcFile& f : cpuMax) {
+            uint64_t quota = 0;
+            if (!f.Read()) continue;
+            TextScanner s(f);
+            if (!ParseCgroupLimit(s, quota)) continue;
+            uint64_t period = s.U64();
+            if (period == 0) continue;
+            float cores = (float)quota / (float)period;
+            if (!cpuLimited || cores < quotaCores) {
+                quotaCores = cores;
+                cpuLimited = true;
+            }
+        }
+    }
+
+    void SampleCpuStat(CgroupStats& cg) {
+        uint64_t raw[CG_COUNTER_COUNT] = { 0 };
+        TextScanner s(cpuStat);
+        while (!s.AtEnd()) {
+            const char* word;
+            size_t len = s.Word(word);
+            if (len == 10 && memcmp(word, "usage_usec", 10) == 0) raw[CG_USAGE] = s.U64();
+            else if (len == 14 && memcmp(word, "throttled_usec", 14) == 0) raw[CG_THROTTLED_USEC] = s.U64();
+            else if (len == 10 && memcmp(word, "nr_periods", 10) == 0) raw[CG_NR_PERIODS] = s.U64();
+            else if (len == 12 && memcmp(word, "nr_throttled", 12) == 0) raw[CG_NR_THROTTLED] = s.U64();
+            s.SkipLine();
+        }
+
+        cg.cpu_used_cores = rates.Rate(CG_USAGE, raw[CG_USAGE]) / 1e6f;
+        cg.throttled_ms_per_s = rates.Rate(CG_THROTTLED_USEC, raw[CG_THROTTLED_USEC]) / 1000.0f;
+        float periods = rates.Rate(CG_NR_PERIODS, raw[CG_NR_PERIODS]);
+        float throttled = rates.Rate(CG_NR_THROTTLED, raw[CG_NR_THROTTLED]);
+        cg.throttled_percent = periods > 0.0f ? std::min(100.0f, throttled * 100.0f / periods) : 0.0f;
+        cg.nr_throttled = raw[CG_NR_THROTTLED];
+    }
+
+public:
+    const char* Name() const override { return "cgroup"; }
+
+    bool Init() override {
+        if (!ReadSelfCgroup(path)) return false;
+
+        std::string dir = "/sys/fs/cgroup" + (path == "/" ? std::string() : path);
+        if (!cpuStat.Open((dir + "/cpu.stat").c_str(), 512)) return false;
+        memoryCurrent.Open((dir + "/memory.current").c_str(), 64);
+
+        // The host's hierarchy root has no memory.max / cpu.max; inside a cgroup
+        // namespace the container's own cgroup is mounted there and does.
+        std::string level = dir;
+        for (;;) {
+            ProcFile f;
+            if (f.Open((level + "/memory.max").c_str(), 64)) memoryMax.push_back(std::move(f));
+            if (f.Open((level + "/cpu.max").c_str(), 64)) cpuMax.push_back(std::move(f));
+            if (level.size() <= strlen("/sys/fs/cgroup")) break;
+            level.resize(level.rfind('/'));
+        }
+
+        rates.Resize(CG_COUNTER_COUNT);
+        return true;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        CgroupStats& cg = snap.cgroup;
+        if (tick++ % LIMIT_PERIOD == 0) ReadLimits();
+        rates.Begin();
+
+        cg.available = true;
+        snprintf(cg.path, sizeof(cg.path), "%s", path.c_str());
+        cg.host_cpu_load = snap.cpu_load;
+        cg.host_ram_total_gb = snap.ram_total_gb;
+
+        if (cpuStat.Read()) SampleCpuStat(cg);
+        float hostCores = (float)std::max<size_t>(1, snap.cpu_cores.Count());
+        cg.cpu_limited = cpuLimited;
+        cg.cpu_quota_cores = cpuLimited ? std::min(quotaCores, hostCores) : hostCores;
+        cg.cpu_percent = std::min(100.0f, cg.cpu_used_cores * 100.0f / cg.cpu_quota_cores);
+
+        uint64_t current = 0;
+        if (memoryCurrent.Read()) {
+            TextScanner s(memoryCurrent);
+            current = s.U64();
+        }
+        cg.memory_used_gb = (float)current * BYTES_TO_GB;
+        cg.memory_limited = memoryLimited;
+        cg.memory_limit_gb = memoryLimited ? std::min((float)memoryLimit * BYTES_TO_GB, snap.ram_total_gb) : snap.ram_total_gb;
+        cg.memory_percent = cg.memory_limit_gb > 0.0f ? std::min(100.0f, cg.memory_used_gb * 100.0f / cg.memory_limit_gb) : 0.0f;
+
+        // Only a real quota replaces the host view; an unlimited cgroup (a desktop
+        // session scope, a container without limits) keeps the host figures.
+        if (cpuLimited) snap.cpu_load = cg.cpu_percent;
+        if (memoryLimited && memoryCurrent.IsOpen()) {
+            snap.ram_total_gb = cg.memory_limit_gb;
+            snap.ram_usage_gb = cg.memory_used_gb;
+            snap.ram_percent = cg.memory_percent;
+        }
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "cgroup_cpu_used", "cores" });
+        out.push_back({ "cgroup_cpu_quota", "cores" });
+        out.push_back({ "cgroup_cpu_percent", "%" });
+        out.push_back({ "cgroup_throttled", "%" });
+        out.push_back({ "cgroup_throttled_time", "ms/s" });
+        out.push_back({ "cgroup_memory_used", "GB" });
+        out.push_back({ "cgroup_memory_limit", "GB" });
+        out.push_back({ "cgroup_memory_percent", "%" });
+    }
+};
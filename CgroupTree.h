@@ -0,0 +1,450 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+#include "SlotMap.h"
+
+// Every cgroup under /sys/fs/cgroup with CPU, memory and IO rolled up the tree.
+// The tree is kept incrementally: each directory has an inotify watch, and only
+// a directory that reported a mkdir/rmdir is re-listed. Only leaves are read each
+// tick, their cpu.stat / memory.current / io.stat kept open while the shared fd
+// budget allows (then opened and closed per tick); interior totals come from one
+// reverse-preorder pass that adds each node into its parent. The root cgroup also
+// holds processes of its own, so its CPU and memory are the host totals from
+// /proc/stat and /proc/meminfo, and its IO is the root io.stat where the kernel
+// has one. Without inotify (or once the watch limit is hit) every directory is
+// re-listed each FALLBACK_RESCAN_TICKS instead. A re-list finds existing children
+// through a map keyed by (parent, name), so it stays linear in the directory size
+// for slices with thousands of children. Past MAX_NODES further cgroups are left
+// out and counted as untracked.
+class CgroupTreeProvider : public SensorProvider {
+private:
+    static const size_t MAX_NODES = 8192;
+    static const size_t MAX_REPORTED = 256;
+    static const int FALLBACK_RESCAN_TICKS = 25;
+    static const size_t LEAF_FILES = 3;
+    static constexpr float FD_SHARE = 0.5f;
+    static const uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+    enum Counter { CT_CPU, CT_READ, CT_WRITE, CT_COUNTER_COUNT };
+    enum RootCounter { RT_CPU, RT_READ, RT_WRITE, RT_COUNTER_COUNT };
+
+    struct Node {
+        std::string path;
+        int parent = -1;
+        int depth = 0;
+        int wd = -1;
+        bool alive = false;
+        bool dirty = false;
+        bool leaf = false;
+        bool pinned = false;
+        int nameSlot = -1;
+        uint32_t scanned = 0;
+        size_t untracked = 0;
+        std::vector<int> children;
+        ProcFile cpuStat;
+        ProcFile memoryCurrent;
+        ProcFile ioStat;
+
+        // Own values for a leaf, rolled-up totals after the reverse pass.
+        float cpu = 0.0f;
+        float memoryMb = 0.0f;
+        float readMbps = 0.0f;
+        float writeMbps = 0.0f;
+        int leaves = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> freeSlots;
+    std::vector<int> order;
+    std::vector<int> stack;
+    std::unordered_map<int, int> byWatch;
+    bool orderDirty = true;
+    size_t liveCount = 0;
+    SlotMap byName;
+    std::vector<int> nameNode;
+    uint32_t scanGen = 0;
+    size_t untrackedCount = 0;
+
+    size_t pinnedFds = 0;
+
+    ProcFile procStat;
+    ProcFile meminfo;
+    ProcFile rootIo;
+    RateStage rootRates;
+    float ticksPerSecond = 100.0f;
+
+    int inotifyFd = -1;
+    bool watching = false;
+    int ticksToRescan = 0;
+    alignas(inotify_event) char events[4096];
+    RateStage rates;
+
+    static std::string DirOf(const std::string& path) { return "/sys/fs/cgroup" + path; }
+
+    static uint64_t ChildKey(int parent, const char* name, size_t len) {
+        return HashName(name, len) + (uint64_t)(parent + 1) * 0x9E3779B97F4A7C15ull;
+    }
+
+    int AddNode(const std::string& path, int parent) {
+        if (liveCount >= MAX_NODES) return -1;
+        int n;
+        if (!freeSlots.empty()) {
+            n = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            n = (int)nodes.size();
+            nodes.emplace_back();
+            rates.Resize(nodes.size() * CT_COUNTER_COUNT);
+        }
+        liveCount++;
+        orderDirty = true;
+
+        Node& node = nodes[n];
+        node.path = path;
+        node.parent = parent;
+        node.depth = parent >= 0 ? nodes[parent].depth + 1 : 0;
+        node.alive = true;
+        node.dirty = false;
+        node.leaf = false;
+        node.pinned = false;
+        node.untracked = 0;
+        node.wd = -1;
+        for (int k = 0; k < CT_COUNTER_COUNT; k++) rates.Reset((size_t)n * CT_COUNTER_COUNT + k);
+
+        if (watching) {
+            node.wd = inotify_add_watch(inotifyFd, SysPath(DirOf(path).c_str()).c_str(), WATCH_MASK);
+            if (node.wd >= 0) byWatch[node.wd] = n;
+            else watching = false;  // ENOSPC: out of watches, fall back to rescans
+        }
+        if (parent >= 0) {
+            size_t slash = path.rfind('/');
+            node.nameSlot = byName.Insert(ChildKey(parent, path.c_str() + slash + 1, path.size() - slash - 1));
+            if ((size_t)node.nameSlot >= nameNode.size()) nameNode.resize(byName.Capacity());
+            nameNode[node.nameSlot] = n;
+            nodes[parent].children.push_back(n);
+        }
+
+        ScanChildren(n);
+        return n;
+    }
+
+    void RemoveNode(int n) {
+        while (!nodes[n].children.empty()) RemoveNode(nodes[n].children.back());
+
+        Node& node = nodes[n];
+        if (node.wd >= 0) {
+            inotify_rm_watch(inotifyFd, node.wd);
+            byWatch.erase(node.wd);
+        }
+        CloseLeaf(node);
+        if (node.nameSlot >= 0) byName.Erase(node.nameSlot);
+        node.nameSlot = -1;
+        untrackedCount -= node.untracked;
+        node.untracked = 0;
+        node.alive = false;
+        if (node.parent >= 0) {
+            std::vector<int>& siblings = nodes[node.parent].children;
+            siblings.erase(std::find(siblings.begin(), siblings.end(), n));
+        }
+        freeSlots.push_back(n);
+        liveCount--;
+        orderDirty = true;
+    }
+
+    // Re-lists one directory: drops child cgroups that are gone, adds (with their
+    // subtrees) the ones that are new, then opens or closes the leaf files to match.
+    // Listed children are stamped with this scan's generation; removal runs before
+    // the additions so freed room under MAX_NODES goes to the new ones.
+    void ScanChildren(int n) {
+        std::string dir = DirOf(nodes[n].path);
+        uint32_t gen = ++scanGen;
+        std::vector<std::string> added;
+
+        if (DIR* d = OpenSysDir(dir.c_str())) {
+            while (dirent* e = readdir(d)) {
+                if (e->d_name[0] == '.') continue;
+                bool isDir = e->d_type == DT_DIR;
+                if (e->d_type == DT_UNKNOWN) {
+                    struct stat st;
+                    isDir = fstatat(dirfd(d), e->d_name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+                }
+                if (!isDir) continue;
+
+                int slot = byName.Find(ChildKey(n, e->d_name, strlen(e->d_name)));
+                if (slot >= 0) nodes[nameNode[slot]].scanned = gen;
+                else added.push_back(nodes[n].path + "/" + e->d_name);
+            }
+            closedir(d);
+        }
+
+        for (size_t i = nodes[n].children.size(); i-- > 0;) {
+            int child = nodes[n].children[i];
+            if (nodes[child].scanned != gen) RemoveNode(child);
+        }
+        size_t missed = 0;
+        for (const std::string& path : added) {
+            if (AddNode(path, n) < 0) missed++;
+        }
+        untrackedCount = untrackedCount - nodes[n].untracked + missed;
+        nodes[n].untracked = missed;
+        UpdateLeafFiles(n);
+    }
+
+    void UpdateLeafFiles(int n) {
+        Node& node = nodes[n];
+        bool leaf = node.children.empty() && n != 0;
+        if (leaf == node.leaf) return;
+        if (leaf) {
+            node.leaf = true;
+            node.pinned = PinnedFds().Acquire(pinnedFds, LEAF_FILES, FD_SHARE);
+            if (node.pinned) OpenLeaf(node);
+            for (int k = 0; k < CT_COUNTER_COUNT; k++) rates.Reset((size_t)n * CT_COUNTER_COUNT + k);
+        }
+        else CloseLeaf(node);
+    }
+
+    static void OpenLeaf(Node& node) {
+        std::string dir = DirOf(node.path);
+        node.cpuStat.Open((dir + "/cpu.stat").c_str(), 512);
+        node.memoryCurrent.Open((dir + "/memory.current").c_str(), 64);
+        node.ioStat.Open((dir + "/io.stat").c_str(), 512);
+    }
+
+    void UnpinLeaf(Node& node) {
+        node.cpuStat.Close();
+        node.memoryCurrent.Close();
+        node.ioStat.Close();
+        if (node.pinned) PinnedFds().Release(pinnedFds, LEAF_FILES);
+        node.pinned = false;
+    }
+
+    void CloseLeaf(Node& node) {
+        UnpinLeaf(node);
+        node.leaf = false;
+    }
+
+    // Marks the directories that saw a subdirectory come or go. A queue overflow
+    // loses events, so everything is re-listed.
+    void DrainEvents() {
+        for (;;) {
+            ssize_t len = read(inotifyFd, events, sizeof(events));
+            ProcIo().syscalls++;
+            if (len <= 0) return;
+            for (char* p = events; p < events + len;) {
+                const inotify_event* ev = (const inotify_event*)p;
+                p += sizeof(inotify_event) + ev->len;
+                if (ev->mask & IN_Q_OVERFLOW) {
+                    for (Node& node : nodes) node.dirty = node.alive;
+                    continue;
+                }
+                if (!(ev->mask & IN_ISDIR)) continue;
+                auto it = byWatch.find(ev->wd);
+                if (it != byWatch.end()) nodes[it->second].dirty = true;
+            }
+        }
+    }
+
+    void RebuildOrder() {
+        order.clear();
+        stack.assign(1, 0);
+        while (!stack.empty()) {
+            int n = stack.back();
+            stack.pop_back();
+            order.push_back(n);
+            const std::vector<int>& kids = nodes[n].children;
+            for (size_t i = kids.size(); i-- > 0;) stack.push_back(kids[i]);
+        }
+        orderDirty = false;
+    }
+
+    void ReadLeaf(int n) {
+        Node& node = nodes[n];
+        size_t slot = (size_t)n * CT_COUNTER_COUNT;
+        if (node.pinned && PinnedFds().Over(pinnedFds, FD_SHARE)) UnpinLeaf(node);
+        if (!node.pinned) OpenLeaf(node);
+
+        uint64_t usage = 0;
+        if (node.cpuStat.Read()) {
+            TextScanner s(node.cpuStat);
+            if (s.Consume("usage_usec", 10)) usage = s.U64();
+        }
+        node.cpu = rates.Rate(slot + CT_CPU, usage) / 1e6f;
+
+        node.memoryMb = 0.0f;
+        if (node.memoryCurrent.Read()) {
+            TextScanner s(node.memoryCurrent);
+            node.memoryMb = (float)s.U64() / (1024.f * 1024.f);
+        }
+
+        // "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0", one line per device.
+        uint64_t rbytes = 0, wbytes = 0;
+        if (node.ioStat.Read()) ParseIoStat(node.ioStat, rbytes, wbytes);
+        node.readMbps = rates.Rate(slot + CT_READ, rbytes) / (1024.f * 1024.f);
+        node.writeMbps = rates.Rate(slot + CT_WRITE, wbytes) / (1024.f * 1024.f);
+        node.leaves = 1;
+
+        if (!node.pinned) {
+            node.cpuStat.Close();
+            node.memoryCurrent.Close();
+            node.ioStat.Close();
+        }
+    }
+
+    // "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0", one line per device.
+    static void ParseIoStat(const ProcFile& f, uint64_t& rbytes, uint64_t& wbytes) {
+        TextScanner s(f);
+        while (!s.AtEnd()) {
+            const char* word;
+            size_t len = s.Word(word);
+            if (len > 7 && memcmp(word, "rbytes=", 7) == 0) rbytes += TextScanner(word + 7, len - 7).U64();
+            else if (len > 7 && memcmp(word, "wbytes=", 7) == 0) wbytes += TextScanner(word + 7, len - 7).U64();
+            else if (len == 0) s.SkipLine();
+        }
+    }
+
+    // The root's own totals, replacing the sum of its children where the host has them.
+    void ReadRoot(Node& root) {
+        rootRates.Begin();
+        if (procStat.Read()) {
+            // "cpu  user nice system idle iowait irq softirq steal ..." in USER_HZ ticks.
+            TextScanner s(procStat);
+            if (s.Consume("cpu ", 4)) {
+                uint64_t v[8] = { 0 };
+                for (int k = 0; k < 8; k++) v[k] = s.U64();
+                uint64_t busy = v[0] + v[1] + v[2] + v[5] + v[6] + v[7];
+                root.cpu = rootRates.Rate(RT_CPU, busy) / ticksPerSecond;
+            }
+        }
+        if (meminfo.Read()) {
+            uint64_t total = 0, free = 0;
+            TextScanner s(meminfo);
+            while (!s.AtEnd() && (!total || !free)) {
+                if (s.Consume("MemTotal:", 9)) total = s.U64();
+                else if (s.Consume("MemFree:", 8)) free = s.U64();
+                s.SkipLine();
+            }
+            if (total >= free) root.memoryMb = (float)(total - free) / 1024.0f;
+        }
+        if (rootIo.IsOpen() && rootIo.Read()) {
+            uint64_t rbytes = 0, wbytes = 0;
+            ParseIoStat(rootIo, rbytes, wbytes);
+            root.readMbps = rootRates.Rate(RT_READ, rbytes) / (1024.f * 1024.f);
+            root.writeMbps = rootRates.Rate(RT_WRITE, wbytes) / (1024.f * 1024.f);
+        }
+    }
+
+    static void Fill(CgroupUsage& out, const Node& node) {
+        size_t slash = node.path.rfind('/');
+        const char* name = slash == std::string::npos ? "/" : node.path.c_str() + slash + 1;
+        snprintf(out.name, sizeof(out.name), "%s", name);
+        out.depth = node.depth;
+        out.leaves = node.leaves;
+        out.cpu_cores = node.cpu;
+        out.memory_mb = node.memoryMb;
+        out.read_mbps = node.readMbps;
+        out.write_mbps = node.writeMbps;
+    }
+
+public:
+    ~CgroupTreeProvider() {
+        if (inotifyFd >= 0) close(inotifyFd);
+    }
+
+    const char* Name() const override { return "cgroup-tree"; }
+
+    bool Init() override {
+        ProcFile controllers;
+        if (!controllers.Open("/sys/fs/cgroup/cgroup.controllers", 256)) return false;
+
+        procStat.Open("/proc/stat", 4096);
+        meminfo.Open("/proc/meminfo", 4096);
+        rootIo.Open("/sys/fs/cgroup/io.stat", 512);
+        rootRates.Resize(RT_COUNTER_COUNT);
+        long hz = sysconf(_SC_CLK_TCK);
+        if (hz > 0) ticksPerSecond = (float)hz;
+
+        PinnedFds();
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        watching = inotifyFd >= 0;
+        nodes.reserve(256);
+        AddNode("", -1);
+        return true;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        if (watching) {
+            DrainEvents();
+            for (size_t i = 0; i < nodes.size(); i++) {
+                if (nodes[i].alive && nodes[i].dirty) {
+                    nodes[i].dirty = false;
+                    ScanChildren((int)i);
+                }
+            }
+        }
+        else if (--ticksToRescan <= 0) {
+            for (size_t i = 0; i < nodes.size(); i++) {
+                if (nodes[i].alive) ScanChildren((int)i);
+            }
+            ticksToRescan = FALLBACK_RESCAN_TICKS;
+        }
+        if (orderDirty) RebuildOrder();
+
+        rates.Begin();
+        for (int n : order) {
+            Node& node = nodes[n];
+            if (node.leaf) ReadLeaf(n);
+            else {
+                node.cpu = node.memoryMb = node.readMbps = node.writeMbps = 0.0f;
+                node.leaves = 0;
+            }
+        }
+
+        // Reverse preorder visits every child before its parent.
+        TopN<CGROUP_TOP> top;
+        for (size_t i = order.size(); i-- > 1;) {
+            const Node& node = nodes[order[i]];
+            Node& parent = nodes[node.parent];
+            parent.cpu += node.cpu;
+            parent.memoryMb += node.memoryMb;
+            parent.readMbps += node.readMbps;
+            parent.writeMbps += node.writeMbps;
+            parent.leaves += node.leaves;
+
+            if (node.children.empty() && node.cpu > 0.0f) top.Offer(node.cpu, order[i]);
+        }
+        snap.cgroup_top_count = top.Count();
+        for (int k = 0; k < top.Count(); k++) Fill(snap.cgroup_top[k], nodes[top[k]]);
+
+        if (!order.empty()) ReadRoot(nodes[order[0]]);
+
+        snap.cgroup_tree.clear();
+        for (size_t i = 0; i < order.size() && i < MAX_REPORTED; i++) {
+            snap.cgroup_tree.emplace_back();
+            Fill(snap.cgroup_tree.back(), nodes[order[i]]);
+        }
+        snap.cgroup_count = (int)order.size();
+        snap.cgroup_untracked = (int)untrackedCount;
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "cgroup_tree_cpu", "cores" });
+        out.push_back({ "cgroup_tree_memory", "MB" });
+        out.push_back({ "cgroup_tree_read", "MB/s" });
+        out.push_back({ "cgroup_tree_write", "MB/s" });
+        out.push_back({ "cgroup_count", "" });
+    }
+};
@@ -0,0 +1,187 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// Cumulative per-logical-CPU time counters, one contiguous array per field so the
+// utilization kernel below streams each column instead of striding through structs.
+struct CpuTimesSoA {
+    std::vector<uint64_t> user;
+    std::vector<uint64_t> system;
+    std::vector<uint64_t> idle;
+    std::vector<uint64_t> iowait;
+    std::vector<uint64_t> steal;
+
+    void Resize(size_t n) {
+        user.resize(n, 0); system.resize(n, 0); idle.resize(n, 0);
+        iowait.resize(n, 0); steal.resize(n, 0);
+    }
+
+    void Swap(CpuTimesSoA& o) {
+        user.swap(o.user); system.swap(o.system); idle.swap(o.idle);
+        iowait.swap(o.iowait); steal.swap(o.steal);
+    }
+};
+
+// Per-core utilization in percent of the interval, same layout as the counters.
+struct CpuCoreLoad {
+    std::vector<float> total;
+    std::vector<float> user;
+    std::vector<float> system;
+    std::vector<float> iowait;
+    std::vector<float> steal;
+
+    int busiest = -1;
+    float busiest_load = 0.0f;
+
+    size_t Count() const { return total.size(); }
+
+    void Resize(size_t n) {
+        total.resize(n, 0.0f); user.resize(n, 0.0f); system.resize(n, 0.0f);
+        iowait.resize(n, 0.0f); steal.resize(n, 0.0f);
+    }
+};
+
+// Per-logical-CPU clocks. capacity[i] is load scaled by cur/max frequency, i.e. the
+// share of the core's full-speed throughput actually delivered.
+struct CpuFreqStats {
+    std::vector<float> cur_mhz;
+    std::vector<float> capacity;
+
+    float avg_mhz = 0.0f;
+    float max_mhz = 0.0f;
+    float effective_capacity = 0.0f;
+
+    uint64_t core_throttle_events = 0;
+    uint64_t package_throttle_events = 0;
+    int throttling_cores = 0;
+
+    size_t Count() const { return cur_mhz.size(); }
+
+    void Resize(size_t n) {
+        cur_mhz.resize(n, 0.0f);
+        capacity.resize(n, 0.0f);
+    }
+};
+
+static const int MAX_IDLE_STATES = 10;
+
+// cpuidle residency histogram: residency[cpu * MAX_IDLE_STATES + state] is the share
+// of the last interval that CPU spent in that idle state, in percent.
+struct CpuIdleStats {
+    int state_count = 0;
+    char state_names[MAX_IDLE_STATES][16] = { { 0 } };
+    std::vector<float> residency;
+
+    float average[MAX_IDLE_STATES] = { 0 };
+    float entries_per_sec[MAX_IDLE_STATES] = { 0 };
+
+    size_t Count() const { return residency.size() / MAX_IDLE_STATES; }
+
+    void Resize(size_t cpus) {
+        residency.resize(cpus * MAX_IDLE_STATES, 0.0f);
+    }
+};
+
+enum CpuCoreType { CPU_TYPE_UNIFORM, CPU_TYPE_PERFORMANCE, CPU_TYPE_EFFICIENCY, CPU_TYPE_COUNT };
+
+// Per-core load folded by topology: mean load per socket, per L3 domain (CCX on
+// AMD), per physical core (SMT siblings merged) and per hybrid core type.
+struct CpuGroupLoad {
+    std::vector<float> socket;
+    std::vector<float> l3;
+    std::vector<float> core;
+    float type[CPU_TYPE_COUNT] = { 0 };
+    bool hybrid = false;
+};
+
+class CpuCoreEngine {
+private:
+    CpuTimesSoA prev;
+    CpuTimesSoA cur;
+    size_t count = 0;
+    bool primed = false;
+
+public:
+    // Grows (never shrinks) the arrays; called when a higher CPU index shows up.
+    void Resize(size_t n) {
+        if (n <= count) return;
+        count = n;
+        prev.Resize(n);
+        cur.Resize(n);
+        primed = false;
+    }
+
+    size_t Count() const { return count; }
+
+    // Writable counters for the sample being collected.
+    CpuTimesSoA& Current() { return cur; }
+
+    // Turns the current-vs-previous counters into per-core percentages and
+    // rotates the buffers. Returns false on the first call (no interval yet).
+    bool Compute(CpuCoreLoad& out) {
+        out.Resize(count);
+        if (!primed) {
+            primed = true;
+            prev.Swap(cur);
+            CopyCounters(prev, cur);
+            return false;
+        }
+
+        const size_t n = count;
+        const uint64_t* __restrict cu = cur.user.data();
+        const uint64_t* __restrict cs = cur.system.data();
+        const uint64_t* __restrict ci = cur.idle.data();
+        const uint64_t* __restrict cw = cur.iowait.data();
+        const uint64_t* __restrict ct = cur.steal.data();
+        const uint64_t* __restrict pu = prev.user.data();
+        const uint64_t* __restrict ps = prev.system.data();
+        const uint64_t* __restrict pi = prev.idle.data();
+        const uint64_t* __restrict pw = prev.iowait.data();
+        const uint64_t* __restrict pt = prev.steal.data();
+        float* __restrict oTotal = out.total.data();
+        float* __restrict oUser = out.user.data();
+        float* __restrict oSystem = out.system.data();
+        float* __restrict oIowait = out.iowait.data();
+        float* __restrict oSteal = out.steal.data();
+
+        // Interval deltas fit comfortably in 32 bits, which keeps the int->float
+        // conversions on the packed fast path. The divisor guard is arithmetic rather than
+        // a select so the loop stays branch-free and vectorizes without fast-math.
+        for (size_t i = 0; i < n; i++) {
+            float du = (float)(int32_t)(cu[i] - pu[i]);
+            float ds = (float)(int32_t)(cs[i] - ps[i]);
+            float di = (float)(int32_t)(ci[i] - pi[i]);
+            float dw = (float)(int32_t)(cw[i] - pw[i]);
+            float dt = (float)(int32_t)(ct[i] - pt[i]);
+            float sum = du + ds + di + dw + dt;
+            float scale = 100.0f / (sum + (float)(sum == 0.0f));
+            oTotal[i] = (du + ds + dt) * scale;
+            oUser[i] = du * scale;
+            oSystem[i] = ds * scale;
+            oIowait[i] = dw * scale;
+            oSteal[i] = dt * scale;
+        }
+
+        out.busiest = -1;
+        out.busiest_load = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            if (oTotal[i] > out.busiest_load) { out.busiest_load = oTotal[i]; out.busiest = (int)i; }
+        }
+
+        prev.Swap(cur);
+        CopyCounters(prev, cur);
+        return true;
+    }
+
+private:
+    // Offline CPUs produce no line, so carry their last counters forward.
+    static void CopyCounters(const CpuTimesSoA& from, CpuTimesSoA& to) {
+        std::copy(from.user.begin(), from.user.end(), to.user.begin());
+        std::copy(from.system.begin(), from.system.end(), to.system.begin());
+        std::copy(from.idle.begin(), from.idle.end(), to.idle.begin());
+        std::copy(from.iowait.begin(), from.iowait.end(), to.iowait.begin());
+        std::copy(from.steal.begin(), from.steal.end(), to.steal.begin());
+    }
+};
@@ -0,0 +1,185 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <dirent.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+
+// Per-core clocks and thermal throttling from sysfs. Frequencies are read once per
+// cpufreq policy rather than per CPU (policies often span a whole cluster), and the
+// throttle counters once per physical core / package, every THROTTLE_TICKS.
+class CpuFreqProvider : public SensorProvider {
+private:
+    static const int THROTTLE_TICKS = 5;
+
+    SysValueSet freqs;
+    std::vector<int> cpuPolicy;
+    std::vector<float> cpuMaxMhz;
+
+    SysValueSet coreThrottle;
+    SysValueSet packageThrottle;
+    std::vector<int64_t> lastCoreThrottle;
+    int throttlingCores = 0;
+    int tick = 0;
+
+    static std::vector<int> ListIndexed(const char* dir, const char* prefix) {
+        std::vector<int> out;
+        size_t n = strlen(prefix);
+        if (DIR* d = OpenSysDir(dir)) {
+            while (dirent* e = readdir(d)) {
+                if (strncmp(e->d_name, prefix, n) != 0 || (unsigned)(e->d_name[n] - '0') > 9) continue;
+                out.push_back(atoi(e->d_name + n));
+            }
+            closedir(d);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    void AddPolicy(const std::string& dir, const std::vector<int>& cpus) {
+        int slot = freqs.Add((dir + "/scaling_cur_freq").c_str());
+        if (slot < 0) return;
+
+        uint64_t maxKhz = 0;
+        ReadFileU64((dir + "/cpuinfo_max_freq").c_str(), maxKhz);
+
+        for (int cpu : cpus) {
+            if (cpu < 0 || (size_t)cpu >= cpuPolicy.size()) continue;
+            cpuPolicy[cpu] = slot;
+            cpuMaxMhz[cpu] = (float)maxKhz / 1000.0f;
+        }
+    }
+
+    void DiscoverFrequencies(int cpuCount) {
+        std::vector<int> cpus;
+        char path[128];
+
+        for (int policy : ListIndexed("/sys/devices/system/cpu/cpufreq", "policy")) {
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpufreq/policy%d/related_cpus", policy);
+            ProcFile f;
+            if (!f.Open(path, 4096) || !f.Read()) continue;
+            ParseCpuList(f.Data(), f.Size(), cpus);
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpufreq/policy%d", policy);
+            AddPolicy(path, cpus);
+        }
+
+        // Older kernels without policy directories: one cpufreq dir per CPU.
+        if (freqs.Size() == 0) {
+            for (int cpu = 0; cpu < cpuCount; cpu++) {
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq", cpu);
+                cpus.assign(1, cpu);
+                AddPolicy(path, cpus);
+            }
+        }
+    }
+
+    void DiscoverThrottle(const std::vector<int>& cpus) {
+        std::vector<uint64_t> cores, packages;
+        char path[128];
+
+        for (int cpu : cpus) {
+            uint64_t pkg = 0;
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+            ReadFileU64(path, pkg);
+
+            uint64_t key = PhysicalCoreKey(cpu);
+            if (std::find(cores.begin(), cores.end(), key) == cores.end()) {
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/thermal_throttle/core_throttle_count", cpu);
+                if (coreThrottle.Add(path) >= 0) cores.push_back(key);
+            }
+            if (std::find(packages.begin(), packages.end(), pkg) == packages.end()) {
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/thermal_throttle/package_throttle_count", cpu);
+                if (packageThrottle.Add(path) >= 0) packages.push_back(pkg);
+            }
+        }
+        lastCoreThrottle.assign(coreThrottle.Size(), -1);
+    }
+
+    void SampleThrottle(CpuFreqStats& out) {
+        if (tick++ % THROTTLE_TICKS == 0) {
+            coreThrottle.ReadAll();
+            packageThrottle.ReadAll();
+
+            throttlingCores = 0;
+            for (size_t i = 0; i < coreThrottle.Size(); i++) {
+                int64_t v = coreThrottle.Value(i);
+                if (lastCoreThrottle[i] >= 0 && v > lastCoreThrottle[i]) throttlingCores++;
+                lastCoreThrottle[i] = v;
+            }
+        }
+
+        uint64_t core = 0, package = 0;
+        for (size_t i = 0; i < coreThrottle.Size(); i++) core += (uint64_t)coreThrottle.Value(i);
+        for (size_t i = 0; i < packageThrottle.Size(); i++) package += (uint64_t)packageThrottle.Value(i);
+        out.core_throttle_events = core;
+        out.package_throttle_events = package;
+        out.throttling_cores = throttlingCores;
+    }
+
+public:
+    const char* Name() const override { return "cpufreq"; }
+
+    bool Init() override {
+        std::vector<int> cpus = ListIndexed("/sys/devices/system/cpu", "cpu");
+        if (cpus.empty()) return false;
+
+        RaiseFdLimit();
+        int count = cpus.back() + 1;
+        cpuPolicy.assign((size_t)count, -1);
+        cpuMaxMhz.assign((size_t)count, 0.0f);
+
+        DiscoverFrequencies(count);
+        DiscoverThrottle(cpus);
+        return freqs.Size() > 0 || coreThrottle.Size() > 0;
+    }
+
+    // Runs after the platform provider, so snap.cpu_cores already holds this tick's load.
+    void Sample(SensorSnapshot& snap) override {
+        CpuFreqStats& out = snap.cpu_freq;
+        out.Resize(cpuPolicy.size());
+        freqs.ReadAll();
+
+        const std::vector<float>& load = snap.cpu_cores.total;
+        float mhzSum = 0.0f, delivered = 0.0f, maxMhzSum = 0.0f, peak = 0.0f;
+        int counted = 0;
+        for (size_t i = 0; i < cpuPolicy.size(); i++) {
+            int slot = cpuPolicy[i];
+            if (slot < 0) continue;
+
+            float mhz = (float)freqs.Value((size_t)slot) / 1000.0f;
+            float busy = i < load.size() ? load[i] : 0.0f;
+            // Without cpuinfo_max_freq the current clock stands in as the ceiling, on
+            // both sides of effective_capacity so it cannot exceed 100%.
+            float maxMhz = cpuMaxMhz[i] > 0.0f ? cpuMaxMhz[i] : mhz;
+
+            out.cur_mhz[i] = mhz;
+            out.capacity[i] = maxMhz > 0.0f ? busy * mhz / maxMhz : 0.0f;
+            mhzSum += mhz;
+            delivered += busy * mhz;
+            maxMhzSum += maxMhz;
+            peak = std::max(peak, maxMhz);
+            counted++;
+        }
+
+        out.avg_mhz = counted ? mhzSum / (float)counted : 0.0f;
+        out.max_mhz = peak;
+        out.effective_capacity = maxMhzSum > 0.0f ? delivered / maxMhzSum : 0.0f;
+
+        SampleThrottle(out);
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "cpu_core_mhz", "MHz" });
+        out.push_back({ "cpu_core_capacity", "%" });
+        out.push_back({ "cpu_avg_mhz", "MHz" });
+        out.push_back({ "cpu_effective_capacity", "%" });
+        out.push_back({ "cpu_core_throttle_events", "" });
+        out.push_back({ "cpu_package_throttle_events", "" });
+        out.push_back({ "cpu_throttling_cores", "" });
+    }
+};
@@ -0,0 +1,157 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <dirent.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+
+// How deep cores sleep, from /sys/devices/system/cpu/cpu*/cpuidle/state*/{time,usage}.
+// Every state's `time` is one pread per tick from a pinned fd; `usage` (entry counts,
+// only needed for the slower-moving entries/s figure) is refreshed every USAGE_TICKS.
+class CpuIdleProvider : public SensorProvider {
+private:
+    static const int USAGE_TICKS = 5;
+
+    size_t cpuCount = 0;
+    int stateCount = 0;
+    char stateNames[MAX_IDLE_STATES][16] = { { 0 } };
+
+    // Both indexed cpu * MAX_IDLE_STATES + state; -1 where a CPU lacks that state.
+    std::vector<int> timeSlot;
+    std::vector<int> usageSlot;
+    SysValueSet times;
+    SysValueSet usages;
+
+    std::vector<int64_t> lastTime;
+    std::vector<int64_t> lastUsage;
+    uint64_t lastNs = 0;
+    uint64_t lastUsageNs = 0;
+    float entryRate[MAX_IDLE_STATES] = { 0 };
+    int tick = 0;
+    bool primed = false;
+
+    static uint64_t NowNs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    }
+
+    void SampleUsage(uint64_t now) {
+        usages.ReadAll();
+        double seconds = (double)(now - lastUsageNs) / 1e9;
+        lastUsageNs = now;
+
+        for (int s = 0; s < stateCount; s++) {
+            int64_t entries = 0;
+            for (size_t c = 0; c < cpuCount; c++) {
+                size_t k = c * MAX_IDLE_STATES + (size_t)s;
+                if (usageSlot[k] < 0) continue;
+                int64_t v = usages.Value((size_t)usageSlot[k]);
+                if (lastUsage[k] >= 0 && v >= lastUsage[k]) entries += v - lastUsage[k];
+                lastUsage[k] = v;
+            }
+            entryRate[s] = (primed && seconds > 0.0) ? (float)((double)entries / seconds) : 0.0f;
+        }
+    }
+
+public:
+    const char* Name() const override { return "cpuidle"; }
+
+    bool Init() override {
+        std::vector<int> cpus;
+        if (DIR* d = OpenSysDir("/sys/devices/system/cpu")) {
+            while (dirent* e = readdir(d)) {
+                if (strncmp(e->d_name, "cpu", 3) != 0 || (unsigned)(e->d_name[3] - '0') > 9) continue;
+                cpus.push_back(atoi(e->d_name + 3));
+            }
+            closedir(d);
+        }
+        if (cpus.empty()) return false;
+        std::sort(cpus.begin(), cpus.end());
+
+        RaiseFdLimit();
+        cpuCount = (size_t)cpus.back() + 1;
+        timeSlot.assign(cpuCount * MAX_IDLE_STATES, -1);
+        usageSlot.assign(cpuCount * MAX_IDLE_STATES, -1);
+
+        char path[128];
+        for (int cpu : cpus) {
+            for (int s = 0; s < MAX_IDLE_STATES; s++) {
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpuidle/state%d/time", cpu, s);
+                int slot = times.Add(path);
+                if (slot < 0) break;
+
+                size_t k = (size_t)cpu * MAX_IDLE_STATES + (size_t)s;
+                timeSlot[k] = slot;
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpuidle/state%d/usage", cpu, s);
+                usageSlot[k] = usages.Add(path);
+
+                if (s >= stateCount) {
+                    stateCount = s + 1;
+                    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpuidle/state%d/name", cpu, s);
+                    ProcFile f;
+                    if (f.Open(path, 64) && f.Read()) {
+                        size_t n = std::min(f.Size(), sizeof(stateNames[s]) - 1);
+                        memcpy(stateNames[s], f.Data(), n);
+                        stateNames[s][n] = '\0';
+                        if (char* nl = strchr(stateNames[s], '\n')) *nl = '\0';
+                    }
+                }
+            }
+        }
+
+        lastTime.assign(cpuCount * MAX_IDLE_STATES, -1);
+        lastUsage.assign(cpuCount * MAX_IDLE_STATES, -1);
+        return stateCount > 0;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        CpuIdleStats& out = snap.cpu_idle;
+        out.Resize(cpuCount);
+        out.state_count = stateCount;
+        memcpy(out.state_names, stateNames, sizeof(stateNames));
+
+        uint64_t now = NowNs();
+        double elapsedUs = (double)(now - lastNs) / 1000.0;
+        lastNs = now;
+        times.ReadAll();
+
+        // `time` is cumulative microseconds in the state; the kernel only folds in an
+        // idle period when the CPU wakes, so a single tick can overshoot slightly.
+        float scale = (primed && elapsedUs > 0.0) ? (float)(100.0 / elapsedUs) : 0.0f;
+        float sum[MAX_IDLE_STATES] = { 0 };
+        int counted[MAX_IDLE_STATES] = { 0 };
+        for (size_t k = 0; k < timeSlot.size(); k++) {
+            int slot = timeSlot[k];
+            if (slot < 0) continue;
+            int64_t v = times.Value((size_t)slot);
+            float r = lastTime[k] >= 0 && v >= lastTime[k] ? (float)(v - lastTime[k]) * scale : 0.0f;
+            r = std::min(r, 100.0f);
+            lastTime[k] = v;
+
+            out.residency[k] = r;
+            size_t s = k % MAX_IDLE_STATES;
+            sum[s] += r;
+            counted[s]++;
+        }
+        for (int s = 0; s < MAX_IDLE_STATES; s++) {
+            out.average[s] = counted[s] ? sum[s] / (float)counted[s] : 0.0f;
+        }
+
+        if (tick++ % USAGE_TICKS == 0) SampleUsage(now);
+        memcpy(out.entries_per_sec, entryRate, sizeof(entryRate));
+        primed = true;
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "cpu_idle_residency", "%" });
+        out.push_back({ "cpu_idle_average", "%" });
+        out.push_back({ "cpu_idle_entries", "1/s" });
+    }
+};
@@ -0,0 +1,185 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <dirent.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+
+// Static CPU topology read once from sysfs. Each logical CPU gets a dense group
+// index per grouping, so folding any per-CPU array is a single linear pass of
+// indexed adds with no lookups.
+class CpuTopology {
+private:
+    std::vector<int> socketOf;
+    std::vector<int> l3Of;
+    std::vector<int> coreOf;
+    std::vector<int> typeOf;
+
+    std::vector<float> socketInv;
+    std::vector<float> l3Inv;
+    std::vector<float> coreInv;
+    float typeInv[CPU_TYPE_COUNT] = { 0 };
+
+    std::vector<float> socketSum;
+    std::vector<float> l3Sum;
+    std::vector<float> coreSum;
+
+    bool hybrid = false;
+
+    static int Dense(std::vector<uint64_t>& keys, uint64_t key) {
+        auto it = std::find(keys.begin(), keys.end(), key);
+        if (it != keys.end()) return (int)(it - keys.begin());
+        keys.push_back(key);
+        return (int)keys.size() - 1;
+    }
+
+    static bool ReadList(const char* path, std::vector<int>& out) {
+        ProcFile f;
+        if (!f.Open(path, 4096) || !f.Read()) return false;
+        ParseCpuList(f.Data(), f.Size(), out);
+        return !out.empty();
+    }
+
+    // First CPU sharing the last-level L3 with `cpu`, or -1 if it has no L3.
+    static int L3Leader(int cpu) {
+        char path[128];
+        std::vector<int> shared;
+        for (int index = 0; index < 8; index++) {
+            uint64_t level = 0;
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu, index);
+            if (!ReadFileU64(path, level)) break;
+            if (level != 3) continue;
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list", cpu, index);
+            if (ReadList(path, shared)) return shared.front();
+        }
+        return -1;
+    }
+
+    static void Inverse(const std::vector<int>& groupOf, size_t groups, std::vector<float>& inv) {
+        std::vector<int> counts(groups, 0);
+        for (int g : groupOf) if (g >= 0) counts[(size_t)g]++;
+        inv.assign(groups, 0.0f);
+        for (size_t g = 0; g < groups; g++) inv[g] = counts[g] ? 1.0f / (float)counts[g] : 0.0f;
+    }
+
+public:
+    size_t Count() const { return socketOf.size(); }
+    size_t Sockets() const { return socketInv.size(); }
+    size_t L3Domains() const { return l3Inv.size(); }
+    size_t PhysicalCores() const { return coreInv.size(); }
+    bool Hybrid() const { return hybrid; }
+
+    bool Discover() {
+        std::vector<int> cpus;
+        if (DIR* d = OpenSysDir("/sys/devices/system/cpu")) {
+            while (dirent* e = readdir(d)) {
+                if (strncmp(e->d_name, "cpu", 3) != 0 || (unsigned)(e->d_name[3] - '0') > 9) continue;
+                cpus.push_back(atoi(e->d_name + 3));
+            }
+            closedir(d);
+        }
+        if (cpus.empty()) return false;
+        std::sort(cpus.begin(), cpus.end());
+
+        size_t n = (size_t)cpus.back() + 1;
+        socketOf.assign(n, -1);
+        l3Of.assign(n, -1);
+        coreOf.assign(n, -1);
+        typeOf.assign(n, CPU_TYPE_UNIFORM);
+
+        // Intel hybrid parts register separate PMUs listing the P- and E-cores.
+        std::vector<int> list;
+        if (ReadList("/sys/devices/cpu_core/cpus", list)) {
+            hybrid = true;
+            for (int c : list) if ((size_t)c < n) typeOf[c] = CPU_TYPE_PERFORMANCE;
+        }
+        if (ReadList("/sys/devices/cpu_atom/cpus", list)) {
+            hybrid = true;
+            for (int c : list) if ((size_t)c < n) typeOf[c] = CPU_TYPE_EFFICIENCY;
+        }
+
+        std::vector<uint64_t> sockets, l3s, cores;
+        char path[128];
+        for (int cpu : cpus) {
+            uint64_t pkg = 0;
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+            if (!ReadFileU64(path, pkg)) continue;
+
+            socketOf[cpu] = Dense(sockets, pkg);
+            coreOf[cpu] = Dense(cores, PhysicalCoreKey(cpu));
+
+            // Without an L3 the socket is the closest shared-cache domain we know of.
+            int leader = L3Leader(cpu);
+            l3Of[cpu] = Dense(l3s, leader >= 0 ? (uint64_t)leader : (1ull << 63) | pkg);
+        }
+
+        Inverse(socketOf, sockets.size(), socketInv);
+        Inverse(l3Of, l3s.size(), l3Inv);
+        Inverse(coreOf, cores.size(), coreInv);
+        std::vector<float> typeInvVec;
+        Inverse(typeOf, CPU_TYPE_COUNT, typeInvVec);
+        for (int t = 0; t < CPU_TYPE_COUNT; t++) typeInv[t] = typeInvVec[(size_t)t];
+
+        socketSum.assign(sockets.size(), 0.0f);
+        l3Sum.assign(l3s.size(), 0.0f);
+        coreSum.assign(cores.size(), 0.0f);
+        return !sockets.empty();
+    }
+
+    // Mean of `values` per group. CPUs beyond Count() or without topology are skipped.
+    void Aggregate(const float* values, size_t count, CpuGroupLoad& out) {
+        std::fill(socketSum.begin(), socketSum.end(), 0.0f);
+        std::fill(l3Sum.begin(), l3Sum.end(), 0.0f);
+        std::fill(coreSum.begin(), coreSum.end(), 0.0f);
+        float typeSum[CPU_TYPE_COUNT] = { 0 };
+
+        size_t n = std::min(count, socketOf.size());
+        for (size_t i = 0; i < n; i++) {
+            if (socketOf[i] < 0) continue;
+            float v = values[i];
+            socketSum[socketOf[i]] += v;
+            l3Sum[l3Of[i]] += v;
+            coreSum[coreOf[i]] += v;
+            typeSum[typeOf[i]] += v;
+        }
+
+        out.socket.resize(socketSum.size());
+        out.l3.resize(l3Sum.size());
+        out.core.resize(coreSum.size());
+        for (size_t g = 0; g < socketSum.size(); g++) out.socket[g] = socketSum[g] * socketInv[g];
+        for (size_t g = 0; g < l3Sum.size(); g++) out.l3[g] = l3Sum[g] * l3Inv[g];
+        for (size_t g = 0; g < coreSum.size(); g++) out.core[g] = coreSum[g] * coreInv[g];
+        for (int t = 0; t < CPU_TYPE_COUNT; t++) out.type[t] = typeSum[t] * typeInv[t];
+        out.hybrid = hybrid;
+    }
+};
+
+// Folds the per-core load produced earlier in the same pass by the platform provider.
+class CpuTopologyProvider : public SensorProvider {
+private:
+    CpuTopology topology;
+
+public:
+    const char* Name() const override { return "cpu-topology"; }
+
+    bool Init() override { return topology.Discover(); }
+
+    void Sample(SensorSnapshot& snap) override {
+        topology.Aggregate(snap.cpu_cores.total.data(), snap.cpu_cores.Count(), snap.cpu_groups);
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "cpu_socket_load", "%" });
+        out.push_back({ "cpu_l3_load", "%" });
+        out.push_back({ "cpu_physical_core_load", "%" });
+        if (topology.Hybrid()) {
+            out.push_back({ "cpu_pcore_load", "%" });
+            out.push_back({ "cpu_ecore_load", "%" });
+        }
+    }
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+#include "SlotMap.h"
+
+enum DiskFilter { DISK_FILTER_WHOLE, DISK_FILTER_PARTITIONS, DISK_FILTER_ALL };
+
+// Block device throughput, IOPS, latency and queue depth from /proc/diskstats.
+// The file is parsed in one pass; each line's major:minor finds its device through
+// a SlotMap, so per-device state only moves when a device appears or disappears.
+// Whether a device is a partition or virtual (dm, md, loop, zram) is looked up in
+// /sys/dev/block once, when it is first seen. Devices that never did any IO since
+// boot (unused loop devices) are left out of the list.
+class DiskStatsProvider : public SensorProvider {
+private:
+    // Columns after "major minor name" that we keep (Documentation/admin-guide/iostats.rst).
+    enum Field {
+        F_READS, F_READS_MERGED, F_SECTORS_READ, F_MS_READING,
+        F_WRITES, F_WRITES_MERGED, F_SECTORS_WRITTEN, F_MS_WRITING,
+        F_IN_FLIGHT, F_MS_IO, F_MS_WEIGHTED, F_FIELD_COUNT
+    };
+
+    enum Counter { C_READS, C_WRITES, C_SECTORS_READ, C_SECTORS_WRITTEN, C_MS_READING, C_MS_WRITING, C_MS_IO, C_MS_WEIGHTED, C_COUNTER_COUNT };
+
+    struct Device {
+        char name[32] = { 0 };
+        bool partition = false;
+        bool isVirtual = false;
+        bool active = false;
+        uint32_t seenTick = 0;
+        DiskDeviceStats stats;
+    };
+
+    static constexpr float SECTOR_TO_MB = 512.0f / (1024.f * 1024.f);
+
+    DiskFilter filter;
+    ProcFile file;
+    SlotMap index;
+    std::vector<Device> devices;
+    RateStage rates;
+    uint32_t tick = 0;
+
+    int Discover(uint64_t key, const char* name, size_t len) {
+        int slot = index.Insert(key);
+        if ((size_t)slot >= devices.size()) {
+            devices.resize(index.Capacity());
+            rates.Resize(index.Capacity() * C_COUNTER_COUNT);
+        }
+        for (int k = 0; k < C_COUNTER_COUNT; k++) rates.Reset((size_t)slot * C_COUNTER_COUNT + k);
+
+        Device& d = devices[slot];
+        d = Device();
+        len = std::min(len, sizeof(d.name) - 1);
+        memcpy(d.name, name, len);
+
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/partition", (unsigned)(key >> 32), (unsigned)key);
+        d.partition = SysExists(path);
+        snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/device", (unsigned)(key >> 32), (unsigned)key);
+        d.isVirtual = !d.partition && !SysExists(path);
+        memcpy(d.stats.name, d.name, sizeof(d.name));
+        d.stats.partition = d.partition;
+        d.stats.is_virtual = d.isVirtual;
+        return slot;
+    }
+
+    void Update(int slot, const uint64_t (&f)[F_FIELD_COUNT]) {
+        Device& d = devices[slot];
+        size_t base = (size_t)slot * C_COUNTER_COUNT;
+        DiskDeviceStats& st = d.stats;
+
+        float reads = rates.Rate(base + C_READS, f[F_READS]);
+        float writes = rates.Rate(base + C_WRITES, f[F_WRITES]);
+        float msRead = rates.Rate(base + C_MS_READING, f[F_MS_READING]);
+        float msWrite = rates.Rate(base + C_MS_WRITING, f[F_MS_WRITING]);
+
+        st.read_iops = reads;
+        st.write_iops = writes;
+        st.read_mbps = rates.Rate(base + C_SECTORS_READ, f[F_SECTORS_READ]) * SECTOR_TO_MB;
+        st.write_mbps = rates.Rate(base + C_SECTORS_WRITTEN, f[F_SECTORS_WRITTEN]) * SECTOR_TO_MB;
+        // Time spent per completed request over the interval (iostat's r_await / w_await / await).
+        st.read_await_ms = reads > 0.0f ? msRead / reads : 0.0f;
+        st.write_await_ms = writes > 0.0f ? msWrite / writes : 0.0f;
+        st.await_ms = reads + writes > 0.0f ? (msRead + msWrite) / (reads + writes) : 0.0f;
+        st.in_flight = (unsigned)f[F_IN_FLIGHT];
+        // Weighted ms per ms is the average queue depth (aqu-sz); busy ms per ms is %util.
+        st.queue_depth = rates.Rate(base + C_MS_WEIGHTED, f[F_MS_WEIGHTED]) / 1000.0f;
+        st.util = std::min(100.0f, rates.Rate(base + C_MS_IO, f[F_MS_IO]) / 10.0f);
+
+        d.active = d.active || f[F_READS] + f[F_WRITES] > 0;
+        d.seenTick = tick;
+    }
+
+    static bool SameName(const Device& d, const char* name, size_t len) {
+        len = std::min(len, sizeof(d.name) - 1);
+        return memcmp(d.name, name, len) == 0 && d.name[len] == '\0';
+    }
+
+    bool Wanted(const Device& d) const {
+        if (!d.active) return false;
+        if (filter == DISK_FILTER_WHOLE) return !d.partition;
+        if (filter == DISK_FILTER_PARTITIONS) return d.partition;
+        return true;
+    }
+
+public:
+    explicit DiskStatsProvider(DiskFilter filter = DISK_FILTER_WHOLE) : filter(filter) {}
+
+    const char* Name() const override { return "diskstats"; }
+
+    bool Init() override {
+        return file.Open("/proc/diskstats", 16384);
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        if (!file.Read()) return;
+        tick++;
+        rates.Begin();
+
+        // "   8       0 sda 1234 56 ..." ; older kernels have 11 columns, newer 15 or 17.
+        TextScanner s(file);
+        while (!s.AtEnd()) {
+            uint64_t major = 0, minor = 0;
+            if (!s.U64(major) || !s.U64(minor)) { s.SkipLine(); continue; }
+            const char* name;
+            size_t len = s.Word(name);
+            uint64_t f[F_FIELD_COUNT] = { 0 };
+            for (int i = 0; i < F_FIELD_COUNT; i++) s.U64(f[i]);
+            s.SkipLine();
+
+            // A recycled major:minor under a different name is a different device.
+            uint64_t key = (major << 32) | minor;
+            int slot = index.Find(key);
+            if (slot < 0 || !SameName(devices[slot], name, len)) slot = Discover(key, name, len);
+            Update(slot, f);
+        }
+
+        snap.disks.clear();
+        DiskAggregate agg;
+        for (size_t i = 0; i < devices.size(); i++) {
+            Device& d = devices[i];
+            if (!index.Used((int)i)) continue;
+            if (d.seenTick != tick) {
+                index.Erase((int)i);
+                continue;
+            }
+            bool listed = Wanted(d);
+            if (listed) snap.disks.push_back(d.stats);
+
+            if (!d.active || d.partition || d.isVirtual) continue;
+            agg.count++;
+            agg.read_mbps += d.stats.read_mbps;
+            agg.write_mbps += d.stats.write_mbps;
+            agg.read_iops += d.stats.read_iops;
+            agg.write_iops += d.stats.write_iops;
+            if (agg.count == 1 || d.stats.util > agg.util_max) {
+                agg.util_max = d.stats.util;
+                agg.busiest = listed ? (int)snap.disks.size() - 1 : -1;
+            }
+        }
+        snap.disk_agg = agg;
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "disk_read", "MB/s" });
+        out.push_back({ "disk_write", "MB/s" });
+        out.push_back({ "disk_read_iops", "1/s" });
+        out.push_back({ "disk_write_iops", "1/s" });
+        out.push_back({ "disk_await", "ms" });
+        out.push_back({ "disk_in_flight", "" });
+        out.push_back({ "disk_queue_depth", "" });
+        out.push_back({ "disk_util", "%" });
+    }
+};
@@ -0,0 +1,340 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <unistd.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "SlotMap.h"
+
+// Per-process GPU usage from the DRM fdinfo keys (Documentation/gpu/drm-usage-stats.rst).
+// Finding the clients means walking every fd of every process, so the /proc listing
+// is swept a slice at a time: one full pass is spread over RESCAN_TICKS ticks, and
+// each tick re-reads only the cached fdinfo files of the clients found so far.
+// Clients are keyed by (drm-pdev, drm-client-id) and the fds that lead to them by
+// (pid, fd), both in SlotMaps, so a known fd or a dup of one costs a lookup.
+class DrmClientProvider : public SensorProvider {
+private:
+    static const int RESCAN_TICKS = 25;
+
+    struct Client {
+        int pid = 0;
+        uint32_t gen = 0;
+        char name[16] = { 0 };
+        ProcFile fdinfo;
+
+        // drm-engine-* is busy time in ns; xe reports drm-cycles-* against drm-total-cycles-*.
+        uint64_t busy[MAX_GPU_ENGINES] = { 0 };
+        uint64_t total[MAX_GPU_ENGINES] = { 0 };
+        uint64_t capacity[MAX_GPU_ENGINES] = { 0 };
+        float util[MAX_GPU_ENGINES] = { 0 };
+        uint64_t memoryKb = 0;
+        bool primed = false;
+    };
+
+    // A /proc/<pid>/fd entry pointing at /dev/dri, and the client behind it (-1 if
+    // its fdinfo carries no drm-client-id).
+    struct DrmFd {
+        uint32_t gen = 0;
+        int client = -1;
+        uint64_t clientKey = 0;
+    };
+
+    SlotMap index;
+    std::vector<Client> clients;
+    SlotMap fdIndex;
+    std::vector<DrmFd> fds;
+    std::vector<int> order;
+    ProcFile probe;
+    ProcDir proc;
+    ProcDir fdDir;
+    uint32_t gen = 1;
+    size_t sweepPids = 0;
+    size_t lastSweepPids = 0;
+    char engines[MAX_GPU_ENGINES][16] = { { 0 } };
+    int engineCount = 0;
+    uint64_t lastNs = 0;
+
+public:
+    const char* Name() const override { return "drm-fdinfo"; }
+
+    bool Init() override {
+        if (!proc.Open("/proc")) return false;
+        Sweep(SIZE_MAX);
+        return true;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        Sweep(lastSweepPids / RESCAN_TICKS + 1);
+
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t now = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+        uint64_t elapsed = now - lastNs;
+        lastNs = now;
+
+        // A client whose fdinfo is gone has closed; a live dup of it is picked up
+        // again when the sweep reaches its process.
+        order.clear();
+        for (size_t n = 0; n < clients.size(); n++) {
+            if (!index.Used((int)n)) continue;
+            if (!clients[n].fdinfo.Read()) {
+                Drop((int)n);
+                continue;
+            }
+            Parse(clients[n], elapsed);
+            order.push_back((int)n);
+        }
+        std::sort(order.begin(), order.end(), [this](int a, int b) { return clients[a].pid < clients[b].pid; });
+
+        // Sorted by pid, so one process is a contiguous run.
+        snap.gpu_procs.clear();
+        for (size_t i = 0; i < order.size(); i++) {
+            const Client& c = clients[order[i]];
+            if (i == 0 || clients[order[i - 1]].pid != c.pid) {
+                snap.gpu_procs.emplace_back();
+                snap.gpu_procs.back().pid = c.pid;
+                memcpy(snap.gpu_procs.back().name, c.name, sizeof(c.name));
+            }
+            GpuProcessStats& p = snap.gpu_procs.back();
+            for (int e = 0; e < engineCount; e++) {
+                p.engine[e] = std::min(100.0f, p.engine[e] + c.util[e]);
+                p.busiest = std::max(p.busiest, p.engine[e]);
+            }
+            p.memory_mb += (float)c.memoryKb / 1024.0f;
+        }
+        std::sort(snap.gpu_procs.begin(), snap.gpu_procs.end(),
+            [](const GpuProcessStats& a, const GpuProcessStats& b) { return a.busiest > b.busiest; });
+
+        memcpy(snap.gpu_engines, engines, sizeof(engines));
+        snap.gpu_engine_count = engineCount;
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "gpu_proc_engine", "%" });
+        out.push_back({ "gpu_proc_memory", "MB" });
+    }
+
+private:
+    int EngineSlot(const char* name, size_t len) {
+        if (len >= sizeof(engines[0])) len = sizeof(engines[0]) - 1;
+        for (int i = 0; i < engineCount; i++) {
+            if (strncmp(engines[i], name, len) == 0 && engines[i][len] == '\0') return i;
+        }
+        if (engineCount == MAX_GPU_ENGINES) return -1;
+        memcpy(engines[engineCount], name, len);
+        engines[engineCount][len] = '\0';
+        return engineCount++;
+    }
+
+    static uint64_t ReadKb(TextScanner& s) {
+        uint64_t v = s.U64();
+        s.SkipBlanks();
+        if (s.StartsWith("KiB", 3)) return v;
+        if (s.StartsWith("MiB", 3)) return v * 1024;
+        if (s.StartsWith("GiB", 3)) return v * 1024 * 1024;
+        return v / 1024;
+    }
+
+    // Reads the counters of one client and turns their deltas into utilization.
+    void Parse(Client& c, uint64_t elapsed) {
+        uint64_t busy[MAX_GPU_ENGINES] = { 0 };
+        uint64_t total[MAX_GPU_ENGINES] = { 0 };
+        uint64_t memoryKb = 0, residentKb = 0;
+
+        TextScanner s(c.fdinfo);
+        while (!s.AtEnd()) {
+            if (!s.Consume("drm-", 4)) { s.SkipLine(); continue; }
+
+            const char* key = s.Pos();
+            s.SkipTo(':');
+            size_t keyLen = (size_t)(s.Pos() - key);
+            s.Skip(':');
+
+            if (keyLen > 16 && memcmp(key, "engine-capacity-", 16) == 0) {
+                int e = EngineSlot(key + 16, keyLen - 16);
+                if (e >= 0) c.capacity[e] = s.U64();
+            }
+            else if (keyLen > 7 && memcmp(key, "engine-", 7) == 0) {
+                int e = EngineSlot(key + 7, keyLen - 7);
+                if (e >= 0) busy[e] = s.U64();
+            }
+            else if (keyLen > 13 && memcmp(key, "total-cycles-", 13) == 0) {
+                int e = EngineSlot(key + 13, keyLen - 13);
+                if (e >= 0) total[e] = s.U64();
+            }
+            else if (keyLen > 7 && memcmp(key, "cycles-", 7) == 0) {
+                int e = EngineSlot(key + 7, keyLen - 7);
+                if (e >= 0) busy[e] = s.U64();
+            }
+            else if (keyLen > 7 && memcmp(key, "memory-", 7) == 0) {
+                memoryKb += ReadKb(s);
+            }
+            else if (keyLen > 9 && memcmp(key, "resident-", 9) == 0) {
+                residentKb += ReadKb(s);
+            }
+            s.SkipLine();
+        }
+        c.memoryKb = residentKb ? residentKb : memoryKb;
+
+        for (int e = 0; e < engineCount; e++) {
+            float util = 0.0f;
+            if (c.primed && busy[e] >= c.busy[e]) {
+                uint64_t delta = busy[e] - c.busy[e];
+                uint64_t span = total[e] ? total[e] - c.total[e] : elapsed;
+                uint64_t cap = c.capacity[e] ? c.capacity[e] : 1;
+                if (span > 0) util = (float)((double)delta * 100.0 / ((double)span * (double)cap));
+            }
+            c.util[e] = std::min(util, 100.0f);
+            c.busy[e] = busy[e];
+            c.total[e] = total[e];
+        }
+        c.primed = true;
+    }
+
+    // drm-client-id is only unique per device, so the key folds in drm-pdev too.
+    static bool Identify(const ProcFile& f, uint64_t& key) {
+        bool hasId = false;
+        uint64_t id = 0;
+        uint64_t device = 1469598103934665603ull;
+        TextScanner s(f);
+        while (!s.AtEnd()) {
+            if (s.Consume("drm-client-id:", 14)) {
+                hasId = s.U64(id);
+            }
+            else if (s.Consume("drm-pdev:", 9)) {
+                const char* w;
+                size_t n = s.Word(w);
+                for (size_t i = 0; i < n; i++) device = (device ^ (unsigned char)w[i]) * 1099511628211ull;
+            }
+            s.SkipLine();
+        }
+        key = (device ^ id) * 1099511628211ull + id;
+        return hasId;
+    }
+
+    void Drop(int slot) {
+        clients[slot].fdinfo.Close();
+        index.Erase(slot);
+    }
+
+    // Scans the next `quota` pids of the /proc listing. At the end of the listing the
+    // pass is complete: fds and clients it did not see are dropped and a new one starts.
+    void Sweep(size_t quota) {
+        const char* name;
+        for (size_t n = 0; n < quota; ) {
+            if (!proc.Next(name)) {
+                FinishSweep();
+                return;
+            }
+            if ((unsigned)(name[0] - '0') > 9) continue;
+            ScanPid(atoi(name));
+            sweepPids++;
+            n++;
+        }
+    }
+
+    void FinishSweep() {
+        for (size_t n = 0; n < fds.size(); n++) {
+            if (fdIndex.Used((int)n) && fds[n].gen != gen) fdIndex.Erase((int)n);
+        }
+        for (size_t n = 0; n < clients.size(); n++) {
+            if (index.Used((int)n) && clients[n].gen != gen) Drop((int)n);
+        }
+        lastSweepPids = sweepPids;
+        sweepPids = 0;
+        gen++;
+        proc.Rewind();
+    }
+
+    void ScanPid(int pid) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%d/fd", pid);
+        if (!fdDir.Open(path)) return;
+
+        char comm[16] = { 0 };
+        const char* name;
+        while (fdDir.Next(name)) {
+            if ((unsigned)(name[0] - '0') > 9) continue;
+
+            char target[64];
+            ssize_t n = readlinkat(fdDir.Fd(), name, target, sizeof(target) - 1);
+            ProcIo().syscalls++;
+            if (n < 9 || memcmp(target, "/dev/dri/", 9) != 0) continue;
+            Track(pid, atoi(name), comm);
+        }
+        fdDir.Close();
+    }
+
+    // Marks the client behind one DRM fd as alive, opening its fdinfo only if neither
+    // the fd nor the client it identifies is already known.
+    void Track(int pid, int fd, char* comm) {
+        uint64_t fdKey = (uint64_t)(uint32_t)pid << 32 | (uint32_t)fd;
+        int f = fdIndex.Find(fdKey);
+        if (f >= 0) {
+            DrmFd& known = fds[f];
+            if (known.client < 0 || index.Find(known.clientKey) == known.client) {
+                known.gen = gen;
+                if (known.client >= 0) clients[known.client].gen = gen;
+                return;
+            }
+        }
+        else {
+            f = fdIndex.Insert(fdKey);
+            if ((size_t)f >= fds.size()) fds.resize(fdIndex.Capacity());
+        }
+
+        DrmFd& entry = fds[f];
+        entry.gen = gen;
+        entry.client = -1;
+
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%d/fdinfo/%d", pid, fd);
+        uint64_t key = 0;
+        bool ok = probe.Open(path, 1024) && probe.Read() && Identify(probe, key);
+        if (!ok) {
+            probe.Close();
+            return;
+        }
+        entry.clientKey = key;
+        entry.client = index.Find(key);
+        if (entry.client >= 0) {
+            clients[entry.client].gen = gen;
+            probe.Close();
+            return;
+        }
+
+        int slot = index.Insert(key);
+        if ((size_t)slot >= clients.size()) clients.resize(index.Capacity());
+        entry.client = slot;
+
+        // Reset field by field: the slot's ProcFile swaps buffers with the probe.
+        Client& c = clients[slot];
+        std::swap(c.fdinfo, probe);
+        probe.Close();
+        c.pid = pid;
+        c.gen = gen;
+        memset(c.busy, 0, sizeof(c.busy));
+        memset(c.total, 0, sizeof(c.total));
+        memset(c.capacity, 0, sizeof(c.capacity));
+        memset(c.util, 0, sizeof(c.util));
+        c.memoryKb = 0;
+        c.primed = false;
+
+        if (!comm[0]) {
+            snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+            if (probe.Open(path, 64) && probe.Read()) {
+                size_t n = std::min(probe.Size(), (size_t)15);
+                memcpy(comm, probe.Data(), n);
+                comm[n] = '\0';
+                if (char* nl = strchr(comm, '\n')) *nl = '\0';
+            }
+            probe.Close();
+        }
+        memcpy(c.name, comm, sizeof(c.name));
+    }
+};
@@ -9,6 +9,7 @@ class Gui {
 private:
     Hardware hw;
     bool isPinned = false; 
+    bool ramExcludeCache = false;
     bool shouldClose = false;
     HWND hwnd = nullptr;
 
@@ -38,6 +39,25 @@ public:
         ImGui::SetCursorPos(ImVec2(16, 8));
         ImGui::TextColored(Theme::Col_TextDim, "SYSTEM MONITOR");
 
+        if (hw.psi_available) {
+            float worst = std::max(hw.psi_cpu, std::max(hw.psi_memory, hw.psi_io));
+            ImGui::SetCursorPos(ImVec2(140, 8));
+            ImGui::TextColored(worst >= 10.0f ? Theme::Col_RAM_Start : Theme::Col_TextDim, "PSI %.0f / %.0f / %.0f", hw.psi_cpu, hw.psi_memory, hw.psi_io);
+            if (ImGui::IsItemHovered()) {
+                const SensorSnapshot& snap = hw.Snapshot();
+                const PsiResource* res[3] = { &snap.psi.cpu, &snap.psi.memory, &snap.psi.io };
+                const char* names[3] = { "CPU", "Memory", "IO" };
+                ImGui::BeginTooltip();
+                ImGui::Text("Pressure stall, %% of time (avg10 / avg60 / now)");
+                for (int i = 0; i < 3; i++) {
+                    ImGui::Text("%-6s some %.1f / %.1f / %.1f", names[i], res[i]->some_avg10, res[i]->some_avg60, res[i]->some_now);
+                    if (i > 0) ImGui::Text("       full %.1f / %.1f / %.1f", res[i]->full_avg10, res[i]->full_avg60, res[i]->full_now);
+                }
+                if (snap.early_samples > 0) ImGui::TextColored(Theme::Col_TextDim, "Early samples on stall: %u", snap.early_samples);
+                ImGui::EndTooltip();
+            }
+        }
+
         if (!isPinned) {
             ImGui::SetCursorPos(ImVec2(size.x - 60, 4));
             if (Theme::IconButton("##Pin", "O", isPinned)) {
@@ -55,21 +75,160 @@ public:
             ImGui::TextColored(ImVec4(1, 1, 1, 0.3f), "Controls in Tray");
         }
 
-        float radius = 38.0f;
+        // Disk (and later rings) only appear when the platform backend reports them.
+        int rings = 3 + (hw.disk_count > 0 ? 1 : 0) + (hw.net_count > 0 ? 1 : 0);
+        float spacing = size.x / (float)rings;
+        float radius = std::min(38.0f, spacing * 0.5f - 6.0f);
         float contentY = 55.0f;
-        float spacing = size.x / 3.0f;
 
         ImGui::SetCursorPos(ImVec2(spacing * 0.5f - radius, contentY));
         char cpuBuf[32]; sprintf(cpuBuf, "%.0f%%", hw.cpu_load);
         Theme::DrawGradientMetric("CPU", cpuBuf, hw.cpu_load, Theme::Col_CPU_Start, Theme::Col_CPU_End, radius);
+        if (ImGui::IsItemHovered() && hw.cpu_busiest_core >= 0) {
+            ImGui::BeginTooltip();
+            ImGui::Text("%d logical CPUs\nBusiest: CPU%d at %.0f%%", hw.cpu_core_count, hw.cpu_busiest_core, hw.cpu_busiest_load);
+            if (hw.cpu_temp > 0.0f) ImGui::Text("Temperature: %.0f C", hw.cpu_temp);
+            const CpuGroupLoad& groups = hw.Snapshot().cpu_groups;
+            for (size_t i = 0; groups.socket.size() > 1 && i < groups.socket.size(); i++) ImGui::Text("Socket %d: %.0f%%", (int)i, groups.socket[i]);
+            if (groups.hybrid) ImGui::Text("P-cores: %.0f%%, E-cores: %.0f%%", groups.type[CPU_TYPE_PERFORMANCE], groups.type[CPU_TYPE_EFFICIENCY]);
+            if (hw.cpu_avg_mhz > 0.0f) ImGui::Text("Clock: %.0f MHz, effective capacity %.0f%%", hw.cpu_avg_mhz, hw.cpu_effective_capacity);
+            if (hw.cpu_deep_idle_state[0]) ImGui::Text("Deepest idle (%s): %.0f%%", hw.cpu_deep_idle_state, hw.cpu_deep_idle);
+            if (hw.cpu_throttling_cores > 0) ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "Thermally throttling: %d core(s)", hw.cpu_throttling_cores);
+            const SchedStats& sched = hw.Snapshot().sched;
+            if (sched.tasks_total > 0) {
+                ImGui::Text("Load average: %.2f %.2f %.2f (%u running, %u blocked)", sched.load1, sched.load5, sched.load15, sched.procs_running, sched.procs_blocked);
+                ImGui::Text("Context switches: %.0f/s, forks: %.0f/s", sched.ctxt_per_s, sched.forks_per_s);
+            }
+            if (sched.schedstat) ImGui::Text("Run-queue latency: %.2f ms mean, %.2f ms on CPU%d", sched.latency_ms_mean, sched.latency_ms_max, sched.latency_worst_core);
+            const InterruptStats& irq = hw.Snapshot().interrupts;
+            if (irq.net_rx_cpu >= 0) {
+                const std::vector<float>& cores = hw.Snapshot().cpu_cores.total;
+                float coreLoad = irq.net_rx_cpu < (int)cores.size() ? cores[irq.net_rx_cpu] : 0.0f;
+                ImVec4 col = irq.net_rx_imbalanced ? ImVec4(1.0f, 0.4f, 0.3f, 1.0f) : Theme::Col_Text;
+                ImGui::TextColored(col, "NET_RX %.0f/s: %.0f%% on CPU%d (at %.0f%%), %.1fx the per-core mean", irq.softirqs[SOFTIRQ_NET_RX].rate,
+                    irq.net_rx_share, irq.net_rx_cpu, coreLoad, irq.net_rx_imbalance);
+            }
+            for (size_t i = 0; i < irq.irqs.size() && i < 3; i++) {
+                const IrqRate& q = irq.irqs[i];
+                ImGui::Text("IRQ %s %s: %.0f/s, %.0f%% on CPU%d", q.name, q.desc, q.rate, q.top_share, q.top_cpu);
+            }
+            const CgroupStats& cg = hw.Snapshot().cgroup;
+            if (cg.cpu_limited) {
+                ImGui::Text("Container quota: %.1f of %.2f cores (host load %.0f%%)", cg.cpu_used_cores, cg.cpu_quota_cores, cg.host_cpu_load);
+                if (cg.throttled_percent > 0.0f) ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "Quota throttled: %.0f%% of periods, %.0f ms/s", cg.throttled_percent, cg.throttled_ms_per_s);
+            }
+            const SensorSnapshot& snap = hw.Snapshot();
+            for (int i = 0; i < snap.cgroup_top_count; i++) {
+                const CgroupUsage& u = snap.cgroup_top[i];
+                ImGui::Text("%s: %.2f cores, %.0f MB", u.name, u.cpu_cores, u.memory_mb);
+            }
+            if (snap.cgroup_untracked > 0)
+                ImGui::TextColored(Theme::Col_TextDim, "  (cgroup tree capped at %d: %d more not tracked)", snap.cgroup_count, snap.cgroup_untracked);
+            const ProcessTable& pt = snap.processes;
+            if (pt.count > 0) {
+                ImGui::Text("%d processes, %d threads (%d running, %d in D state, %d zombie)", pt.count, pt.threads, pt.running, pt.uninterruptible, pt.zombies);
+                for (size_t i = 0; i < pt.top.size() && i < 5; i++) {
+                    const ProcessStats& p = pt.top[i];
+                    ImGui::Text("%s (%d) %c: %.0f%%, %.0f MB, %u threads", p.name, p.pid, p.state, p.cpu_percent, p.rss_mb, p.threads);
+                }
+            }
+            ImGui::EndTooltip();
+        }
 
         ImGui::SetCursorPos(ImVec2(spacing * 1.5f - radius, contentY));
         char gpuBuf[32]; sprintf(gpuBuf, "%.0f%%", hw.gpu_load);
         Theme::DrawGradientMetric("GPU", gpuBuf, hw.gpu_load, Theme::Col_GPU_Start, Theme::Col_GPU_End, radius);
+        const std::vector<GpuProcessStats>& gpuProcs = hw.Snapshot().gpu_procs;
+        if (ImGui::IsItemHovered() && (hw.gpu_count > 0 || !gpuProcs.empty())) {
+            ImGui::BeginTooltip();
+            if (hw.gpu_count > 0) {
+                ImGui::Text("%d GPU(s), ring shows busiest\nMean load: %.0f%%\nVRAM: %.1f / %.1f GB\nPower: %.0f W\nThrottled: %d", hw.gpu_count, hw.gpu_load_mean,
+                    hw.gpu_vram_used, hw.gpu_vram_total, hw.gpu_power_w, hw.gpu_throttled);
+            }
+            for (size_t i = 0; i < gpuProcs.size() && i < 3; i++) {
+                ImGui::Text("%s (%d): %.0f%%, %.0f MB", gpuProcs[i].name, gpuProcs[i].pid, gpuProcs[i].busiest, gpuProcs[i].memory_mb);
+            }
+            ImGui::EndTooltip();
+        }
 
         ImGui::SetCursorPos(ImVec2(spacing * 2.5f - radius, contentY));
-        char ramBuf[32]; sprintf(ramBuf, "%.1f", hw.ram_usage_gb);
-        Theme::DrawGradientMetric("RAM", ramBuf, hw.ram_percent, Theme::Col_RAM_Start, Theme::Col_RAM_End, radius);
+        char ramBuf[32]; sprintf(ramBuf, "%.1f", ramExcludeCache ? hw.ram_no_cache_gb : hw.ram_usage_gb);
+        Theme::DrawGradientMetric(ramExcludeCache ? "RAM -CACHE" : "RAM", ramBuf, ramExcludeCache ? hw.ram_no_cache_percent : hw.ram_percent,
+            Theme::Col_RAM_Start, Theme::Col_RAM_End, radius);
+        if (ImGui::IsItemClicked()) ramExcludeCache = !ramExcludeCache;
+        if (ImGui::IsItemHovered()) {
+            const MemBreakdown& mem = hw.Snapshot().mem;
+            ImGui::BeginTooltip();
+            ImGui::Text("Used: %.1f / %.1f GB\nExcluding reclaimable cache: %.1f GB", hw.ram_usage_gb, hw.ram_total_gb, hw.ram_no_cache_gb);
+            if (mem.cached_gb > 0.0f) {
+                ImGui::Text("Cached: %.1f GB, Buffers: %.2f GB, Shmem: %.1f GB", mem.cached_gb, mem.buffers_gb, mem.shmem_gb);
+                ImGui::Text("Slab: %.1f GB (%.1f reclaimable), THP: %.1f GB", mem.slab_gb, mem.slab_reclaimable_gb, mem.anon_huge_gb);
+                ImGui::Text("Dirty: %.0f MB, Writeback: %.0f MB", mem.dirty_mb, mem.writeback_mb);
+            }
+            if (mem.swap_total_gb > 0.0f) ImGui::Text("Swap: %.1f / %.1f GB", mem.swap_used_gb, mem.swap_total_gb);
+            const CgroupStats& cg = hw.Snapshot().cgroup;
+            if (cg.memory_limited) ImGui::Text("Container limit: %.1f GB of %.1f GB host (breakdown is host-wide)", cg.memory_limit_gb, cg.host_ram_total_gb);
+            const VmRates& vm = hw.Snapshot().vm;
+            if (vm.pgfault > 0.0f) {
+                ImGui::Text("Faults: %.0f/s (%.0f major), swap in/out: %.0f / %.0f pages/s", vm.pgfault, vm.pgmajfault, vm.pswpin + vm.zswpin, vm.pswpout + vm.zswpout);
+                ImGui::Text("Reclaim scan: %.0f kswapd, %.0f direct, %.0f khugepaged pages/s", vm.pgscan_kswapd, vm.pgscan_direct, vm.pgscan_khugepaged);
+            }
+            if (vm.zram_devices > 0) ImGui::Text("zram: %.0f MB -> %.0f MB (%.1fx)", vm.zram_orig_mb, vm.zram_used_mb, vm.zram_ratio);
+            if (mem.hugepages_total > 0) ImGui::Text("Hugepages: %u / %u free (%.0f MB)", mem.hugepages_free, mem.hugepages_total, mem.hugepage_size_mb);
+            ImGui::TextColored(Theme::Col_TextDim, "Click to toggle cache");
+            ImGui::EndTooltip();
+        }
+
+        if (hw.disk_count > 0) {
+            ImGui::SetCursorPos(ImVec2(spacing * 3.5f - radius, contentY));
+            char diskBuf[32]; sprintf(diskBuf, "%.0f", hw.disk_read_mbps + hw.disk_write_mbps);
+            Theme::DrawGradientMetric("DISK", diskBuf, hw.disk_util, Theme::Col_DISK_Start, Theme::Col_DISK_End, radius);
+            if (ImGui::IsItemHovered()) {
+                const std::vector<DiskDeviceStats>& disks = hw.Snapshot().disks;
+                ImGui::BeginTooltip();
+                ImGui::Text("Read %.1f MB/s, write %.1f MB/s; ring shows busiest disk %%util", hw.disk_read_mbps, hw.disk_write_mbps);
+                for (size_t i = 0; i < disks.size() && i < 8; i++) {
+                    const DiskDeviceStats& d = disks[i];
+                    ImGui::Text("%s: R %.1f / W %.1f MB/s, %.0f IOPS, await %.1f ms, queue %.1f, %.0f%%", d.name, d.read_mbps, d.write_mbps,
+                        d.read_iops + d.write_iops, d.await_ms, d.queue_depth, d.util);
+                }
+                ImGui::EndTooltip();
+            }
+        }
+
+        if (hw.net_count > 0) {
+            ImGui::SetCursorPos(ImVec2(spacing * (rings - 0.5f) - radius, contentY));
+            char netBuf[32]; sprintf(netBuf, "%.0f", hw.net_rx_mbit + hw.net_tx_mbit);
+            Theme::DrawGradientMetric("NET", netBuf, hw.net_link_percent, Theme::Col_NET_Start, Theme::Col_NET_End, radius);
+            if (ImGui::IsItemHovered()) {
+                const std::vector<NetInterfaceStats>& nets = hw.Snapshot().nets;
+                ImGui::BeginTooltip();
+                ImGui::Text("RX %.1f Mbit/s, TX %.1f Mbit/s; ring shows busiest link vs line rate", hw.net_rx_mbit, hw.net_tx_mbit);
+                for (size_t i = 0; i < nets.size() && i < 8; i++) {
+                    const NetInterfaceStats& n = nets[i];
+                    ImGui::Text("%s: RX %.1f / TX %.1f Mbit/s, %.0f pkt/s", n.name, n.rx_mbit, n.tx_mbit, n.rx_packets + n.tx_packets);
+                    if (n.speed_mbit > 0.0f) { ImGui::SameLine(); ImGui::Text("(%.0f%% of %.0f Mbit/s)", n.link_percent, n.speed_mbit); }
+                    float bad = n.rx_drops + n.tx_drops + n.rx_errors + n.tx_errors;
+                    if (bad > 0.0f) ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "  drops %.0f/s, errors %.0f/s", n.rx_drops + n.tx_drops, n.rx_errors + n.tx_errors);
+                }
+                if (nets.size() > 8) ImGui::TextColored(Theme::Col_TextDim, "+%d more", (int)nets.size() - 8);
+                const SocketStats& so = hw.Snapshot().sockets;
+                if (so.available) {
+                    ImGui::Separator();
+                    ImGui::Text("TCP %d sockets: %d established, %d listen, %d time-wait; UDP %d", so.tcp_total,
+                        so.tcp_state[1], so.tcp_state[10], so.tcp_state[6], so.udp_total);
+                    ImGui::Text("Retransmits %.0f/s (%.2f%%), resets %.0f/s", so.retrans_per_s, so.retrans_percent, so.out_rsts_per_s);
+                    if (so.udp_drops > 0 || so.udp_rcvbuf_errors_per_s > 0.0f)
+                        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "UDP drops %llu, rcvbuf errors %.0f/s", (unsigned long long)so.udp_drops, so.udp_rcvbuf_errors_per_s);
+                    for (int i = 0; i < so.top_peer_count; i++) ImGui::Text("  peer %s: %d", so.top_peers[i].addr, so.top_peers[i].count);
+                    if (so.untracked_peer_sockets > 0)
+                        ImGui::TextColored(Theme::Col_TextDim, "  (peers beyond the first %d not ranked: %u sockets)", so.distinct_peers, so.untracked_peer_sockets);
+                    for (int i = 0; i < so.top_port_count; i++) ImGui::Text("  port %u: %d", (unsigned)so.top_ports[i].port, so.top_ports[i].count);
+                    ImGui::TextColored(Theme::Col_TextDim, "%u rows scanned in %.1f ms", so.scan_rows, so.scan_us / 1000.0f);
+                }
+                ImGui::EndTooltip();
+            }
+        }
 
         if (!isPinned) {
             float sliderWidth = 140.0f;
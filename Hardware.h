@@ -1,149 +1,101 @@
 #pragma once
 
-#ifdef min
-#undef min
-#endif
-#ifdef max
-#undef max
-#endif
-
-#include <windows.h>
 #include <vector>
+#include <cstring>
 #include <cmath>
 #include <algorithm>
-#include <numeric> 
-#include <string>
-#include <pdh.h>
-#include <pdhmsg.h>
-
-#pragma comment(lib, "pdh.lib")
-
-#ifndef PDH_CSTATUS_VALID
-#define PDH_CSTATUS_VALID ((DWORD)0x00000000L)
+#include <thread>
+#include <chrono>
+#include "SensorProvider.h"
+#include "TripleBuffer.h"
+
+#ifdef _WIN32
+#include "WinSensors.h"
+#else
+#include "LinuxSensors.h"
 #endif
-#ifndef PDH_CSTATUS_NEW_DATA
-#define PDH_CSTATUS_NEW_DATA ((DWORD)0x00000001L)
-#endif
-
-typedef struct nvmlDevice_st* nvmlDevice_t;
-typedef struct nvmlUtilization_st { unsigned int gpu; unsigned int memory; } nvmlUtilization_t;
-typedef struct nvmlMemory_st { unsigned long long total; unsigned long long free; unsigned long long used; } nvmlMemory_t;
-
-typedef int(*nvmlInit_t)();
-typedef int(*nvmlShutdown_t)();
-typedef int(*nvmlDeviceGetHandleByIndex_t)(unsigned int, nvmlDevice_t*);
-typedef int(*nvmlDeviceGetUtilizationRates_t)(nvmlDevice_t, nvmlUtilization_st*);
-typedef int(*nvmlDeviceGetTemperature_t)(nvmlDevice_t, int, unsigned int*);
-typedef int(*nvmlDeviceGetMemoryInfo_t)(nvmlDevice_t, nvmlMemory_t*);
-
-typedef void* (*ADL_MAIN_MALLOC_CALLBACK)(int);
-typedef struct AdapterInfo {
-    int iSize; int iAdapterIndex; char strUDID[256]; int iBusNumber; int iDeviceNumber; int iFunctionNumber; int iVendorID;
-    char strAdapterName[256]; char strDisplayName[256]; int iPresent; int iExist; char strDriverPath[256]; char strDriverPathExt[256];
-    char strPNPString[256]; int iOSDisplayIndex;
-} AdapterInfo;
-
-typedef struct ADLPMActivity {
-    int iSize; int iEngineClock; int iMemoryClock; int iVddc; int iActivityPercent;
-    int iCurrentPerformanceLevel; int iCurrentBusSpeed; int iCurrentBusLanes; int iMaximumBusLanes; int iReserved;
-} ADLPMActivity;
-
-typedef struct ADLMemoryInfo {
-    long long iMemorySize; char strMemoryType[256]; long long iMemoryBandwidth;
-} ADLMemoryInfo;
-
-typedef int(*ADL_Main_Control_Create_t)(ADL_MAIN_MALLOC_CALLBACK, int);
-typedef int(*ADL_Main_Control_Destroy_t)();
-typedef int(*ADL_Adapter_NumberOfAdapters_Get_t)(int*);
-typedef int(*ADL_Adapter_AdapterInfo_Get_t)(AdapterInfo*, int);
-typedef int(*ADL_Overdrive5_CurrentActivity_Get_t)(int, ADLPMActivity*);
-typedef int(*ADL_Adapter_MemoryInfo_Get_t)(int, ADLMemoryInfo*);
-
-void* __stdcall ADL_Main_Memory_Alloc(int iSize) { return malloc(iSize); }
-
-
-inline ULONGLONG FT2ULL(FILETIME ft) {
-    ULARGE_INTEGER li;
-    li.LowPart = ft.dwLowDateTime;
-    li.HighPart = ft.dwHighDateTime;
-    return li.QuadPart;
-}
 
+// Sensors are sampled on a dedicated thread; the render thread only ever reads
+// the latest published snapshot and never blocks on a driver call.
 class Hardware {
 private:
-    PDH_HQUERY cpuQuery = NULL;
-    PDH_HCOUNTER cpuCounter = NULL;
-
-    static const int CPU_BUFFER_SIZE = 10;
-    std::vector<float> cpuBuffer;
-    int bufferIndex = 0;
-
-    enum GpuSource { SOURCE_NONE, SOURCE_NVIDIA, SOURCE_AMD, SOURCE_PDH };
-    GpuSource gpuSource = SOURCE_NONE;
-
-    PDH_HQUERY gpuQuery = NULL;
-    PDH_HCOUNTER gpuCounter = NULL;
-    bool pdhGpuInit = false;
-    std::vector<BYTE> pdhRawBuffer; 
+    static const int SAMPLE_PERIOD_MS = 200;
 
-    HMODULE hNvml = nullptr;
-    nvmlDevice_t nvidiaDevice = nullptr;
-    nvmlDeviceGetUtilizationRates_t nvmlGetUsage = nullptr;
-    nvmlDeviceGetTemperature_t nvmlGetTemp = nullptr;
-    nvmlDeviceGetMemoryInfo_t nvmlGetMem = nullptr;
+    SensorProviderList providers;
+    std::vector<SensorProvider*> wakeProviders;
+    SensorSnapshot work;
+    TripleBuffer<SensorSnapshot> published;
 
-    HMODULE hAdl = nullptr;
-    int amdAdapterIndex = -1;
-    ADL_Overdrive5_CurrentActivity_Get_t adlGetActivity = nullptr;
-    ADL_Adapter_MemoryInfo_Get_t adlGetMemInfo = nullptr;
-    long long amdTotalVram = 0;
-
-    float target_cpu = 0.0f;
-    float target_gpu = 0.0f;
-    float target_ram_load = 0.0f;
+    std::thread sampler;
+    SamplerWaiter waiter;
 
 public:
     float cpu_load = 0.0f;
+    int cpu_core_count = 0;
+    int cpu_busiest_core = -1;
+    float cpu_busiest_load = 0.0f;
+    float cpu_temp = 0.0f;
+    float cpu_avg_mhz = 0.0f;
+    float cpu_effective_capacity = 0.0f;
+    int cpu_throttling_cores = 0;
+    float cpu_deep_idle = 0.0f;
+    char cpu_deep_idle_state[16] = { 0 };
 
     float gpu_load = 0.0f;
     float gpu_temp = 0.0f;
     float gpu_vram_used = 0.0f;
     float gpu_vram_total = 0.0f;
+    int gpu_count = 0;
+    float gpu_load_mean = 0.0f;
+    float gpu_power_w = 0.0f;
+    int gpu_throttled = 0;
 
     float ram_usage_gb = 0.0f;
     float ram_percent = 0.0f;
     float ram_total_gb = 0.0f;
+    float ram_no_cache_gb = 0.0f;
+    float ram_no_cache_percent = 0.0f;
 
-    Hardware() {
-        cpuBuffer.resize(CPU_BUFFER_SIZE, 0.0f);
-        InitCPU();
+    int disk_count = 0;
+    float disk_util = 0.0f;
+    float disk_read_mbps = 0.0f;
+    float disk_write_mbps = 0.0f;
+
+    int net_count = 0;
+    float net_link_percent = 0.0f;
+    float net_rx_mbit = 0.0f;
+    float net_tx_mbit = 0.0f;
 
-        if (InitNvidia()) gpuSource = SOURCE_NVIDIA;
-        else if (InitAMD()) gpuSource = SOURCE_AMD;
-        else if (InitUniversalGPU()) gpuSource = SOURCE_PDH;
+    // Share of the last 10 s some task was stalled on each resource (PSI "some avg10").
+    bool psi_available = false;
+    float psi_cpu = 0.0f;
+    float psi_memory = 0.0f;
+    float psi_io = 0.0f;
 
-        MEMORYSTATUSEX memInfo;
-        memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-        if (GlobalMemoryStatusEx(&memInfo)) {
-            ram_total_gb = (float)memInfo.ullTotalPhys / (1024.f * 1024.f * 1024.f);
+    Hardware() {
+        CreatePlatformProviders(providers);
+        providers.erase(std::remove_if(providers.begin(), providers.end(),
+            [](const std::unique_ptr<SensorProvider>& p) { return !p->Init(); }), providers.end());
+
+        std::vector<int> wakeFds;
+        for (auto& p : providers) {
+            size_t before = wakeFds.size();
+            p->WakeFds(wakeFds);
+            if (wakeFds.size() > before) wakeProviders.push_back(p.get());
         }
-    }
+        waiter.Init(wakeFds);
 
-    ~Hardware() {
-        if (cpuQuery) PdhCloseQuery(cpuQuery);
-        if (pdhGpuInit) PdhCloseQuery(gpuQuery);
+        SampleOnce();
+        const SensorSnapshot& s = published.Read();
+        ram_total_gb = s.ram_total_gb;
+        gpu_vram_total = s.gpu_vram_total;
 
-        if (hNvml) {
-            auto nvmlShutdown = (nvmlShutdown_t)GetProcAddress(hNvml, "nvmlShutdown");
-            if (nvmlShutdown) nvmlShutdown();
-            FreeLibrary(hNvml);
-        }
+        sampler = std::thread([this] { SamplerLoop(); });
+    }
 
-        if (hAdl) {
-            auto adlDestroy = (ADL_Main_Control_Destroy_t)GetProcAddress(hAdl, "ADL_Main_Control_Destroy");
-            if (adlDestroy) adlDestroy();
-            FreeLibrary(hAdl);
-        }
+    ~Hardware() {
+        waiter.Stop();
+        if (sampler.joinable()) sampler.join();
     }
 
     float Lerp(float a, float b, float t) {
@@ -151,210 +103,101 @@ public:
         return a + (b - a) * t;
     }
 
-    void InitCPU() {
-        cpuQuery = NULL;
-        cpuCounter = NULL;
+    // Render-thread view of the most recent snapshot, refreshed by Update().
+    const SensorSnapshot& Snapshot() const { return published.Latest(); }
 
-        FILETIME idle, kernel, user;
-        GetSystemTimes(&idle, &kernel, &user);
+    void Describe(std::vector<MetricDesc>& out) const {
+        for (auto& p : providers) p->Describe(out);
+        out.push_back({ "sample_us", "us" });
+        out.push_back({ "sample_syscalls", "" });
     }
 
-
-    void MeasureCPU() {
-        static ULONGLONG lastIdle = 0;
-        static ULONGLONG lastKernel = 0;
-        static ULONGLONG lastUser = 0;
-        static bool inited = false;
-
-        FILETIME idleFT, kernelFT, userFT;
-        if (!GetSystemTimes(&idleFT, &kernelFT, &userFT)) return;
-
-        ULONGLONG idle = FT2ULL(idleFT);
-        ULONGLONG kernel = FT2ULL(kernelFT);
-        ULONGLONG user = FT2ULL(userFT);
-
-        if (!inited) {
-            lastIdle = idle;
-            lastKernel = kernel;
-            lastUser = user;
-            inited = true;
-            target_cpu = 0.0f;
-            return;
+    void Update(float deltaTime) {
+        const SensorSnapshot& s = published.Read();
+
+        cpu_core_count = (int)s.cpu_cores.Count();
+        cpu_busiest_core = s.cpu_cores.busiest;
+        cpu_busiest_load = s.cpu_cores.busiest_load;
+        cpu_temp = s.cpu_temp;
+        cpu_avg_mhz = s.cpu_freq.avg_mhz;
+        cpu_effective_capacity = s.cpu_freq.effective_capacity;
+        cpu_throttling_cores = s.cpu_freq.throttling_cores;
+        if (s.cpu_idle.state_count > 0) {
+            int deepest = s.cpu_idle.state_count - 1;
+            cpu_deep_idle = s.cpu_idle.average[deepest];
+            memcpy(cpu_deep_idle_state, s.cpu_idle.state_names[deepest], sizeof(cpu_deep_idle_state));
         }
 
-        ULONGLONG idleDiff = idle - lastIdle;
-        ULONGLONG totalDiff = (kernel - lastKernel) + (user - lastUser);
-
-        lastIdle = idle;
-        lastKernel = kernel;
-        lastUser = user;
-
-        if (totalDiff == 0) return;
-
-        double cpu = (1.0 - (double)idleDiff / (double)totalDiff) * 100.0;
+        gpu_temp = s.gpu_temp;
+        gpu_vram_used = s.gpu_vram_used;
+        gpu_vram_total = s.gpu_vram_total;
+        gpu_count = s.gpu_agg.count;
+        gpu_load_mean = s.gpu_agg.load_mean;
+        gpu_power_w = s.gpu_agg.power_sum_w;
+        gpu_throttled = s.gpu_agg.throttled_count;
+        ram_usage_gb = s.ram_usage_gb;
+        ram_total_gb = s.ram_total_gb;
+        ram_no_cache_gb = s.mem.used_no_cache_gb;
+        disk_count = s.disk_agg.count;
+        disk_read_mbps = s.disk_agg.read_mbps;
+        disk_write_mbps = s.disk_agg.write_mbps;
+        net_count = s.net_agg.count;
+        net_rx_mbit = s.net_agg.rx_mbit;
+        net_tx_mbit = s.net_agg.tx_mbit;
+        psi_available = s.psi.available;
+        psi_cpu = s.psi.cpu.some_avg10;
+        psi_memory = s.psi.memory.some_avg10;
+        psi_io = s.psi.io.some_avg10;
 
-        if (cpu < 0.0) cpu = 0.0;
-        if (cpu > 100.0) cpu = 100.0;
-
-        target_cpu = (float)cpu;
-    }
-
-    bool InitNvidia() {
-        hNvml = LoadLibrary(L"nvml.dll");
-        if (!hNvml) hNvml = LoadLibrary(L"C:\\Program Files\\NVIDIA Corporation\\NVSMI\\nvml.dll");
-        if (!hNvml) return false;
-
-        auto nvmlInit = (nvmlInit_t)GetProcAddress(hNvml, "nvmlInit_v2");
-        if (!nvmlInit) nvmlInit = (nvmlInit_t)GetProcAddress(hNvml, "nvmlInit");
-        auto nvmlGetHandle = (nvmlDeviceGetHandleByIndex_t)GetProcAddress(hNvml, "nvmlDeviceGetHandleByIndex_v2");
-
-        nvmlGetUsage = (nvmlDeviceGetUtilizationRates_t)GetProcAddress(hNvml, "nvmlDeviceGetUtilizationRates");
-        nvmlGetTemp = (nvmlDeviceGetTemperature_t)GetProcAddress(hNvml, "nvmlDeviceGetTemperature");
-        nvmlGetMem = (nvmlDeviceGetMemoryInfo_t)GetProcAddress(hNvml, "nvmlDeviceGetMemoryInfo");
-
-        if (nvmlInit && nvmlGetHandle && nvmlGetUsage && nvmlInit() == 0) {
-            if (nvmlGetHandle(0, &nvidiaDevice) == 0) {
-                if (nvmlGetMem) {
-                    nvmlMemory_t mem = { 0 };
-                    if (nvmlGetMem(nvidiaDevice, &mem) == 0) {
-                        gpu_vram_total = (float)mem.total / (1024.f * 1024.f * 1024.f);
-                    }
-                }
-                return true;
-            }
-        }
-        FreeLibrary(hNvml); hNvml = nullptr;
-        return false;
+        float smoothSpeed = deltaTime * 5.0f;
+        cpu_load = Lerp(cpu_load, s.cpu_load, smoothSpeed);
+        gpu_load = Lerp(gpu_load, s.gpu_load, smoothSpeed);
+        ram_percent = Lerp(ram_percent, s.ram_percent, smoothSpeed);
+        ram_no_cache_percent = Lerp(ram_no_cache_percent, s.mem.used_no_cache_percent, smoothSpeed);
+        disk_util = Lerp(disk_util, s.disk_agg.util_max, smoothSpeed);
+        net_link_percent = Lerp(net_link_percent, s.net_agg.link_percent_max, smoothSpeed);
     }
 
-    bool InitAMD() {
-        hAdl = LoadLibrary(L"atiadlxx.dll");
-        if (!hAdl) hAdl = LoadLibrary(L"atiadlxy.dll");
-        if (!hAdl) return false;
-
-        auto adlCreate = (ADL_Main_Control_Create_t)GetProcAddress(hAdl, "ADL_Main_Control_Create");
-        auto adlNumAdapters = (ADL_Adapter_NumberOfAdapters_Get_t)GetProcAddress(hAdl, "ADL_Adapter_NumberOfAdapters_Get");
-        auto adlGetInfo = (ADL_Adapter_AdapterInfo_Get_t)GetProcAddress(hAdl, "ADL_Adapter_AdapterInfo_Get");
-        adlGetActivity = (ADL_Overdrive5_CurrentActivity_Get_t)GetProcAddress(hAdl, "ADL_Overdrive5_CurrentActivity_Get");
-        adlGetMemInfo = (ADL_Adapter_MemoryInfo_Get_t)GetProcAddress(hAdl, "ADL_Adapter_MemoryInfo_Get");
+private:
+    void SampleOnce() {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t syscalls = PlatformIoSyscalls();
 
-        if (adlCreate && adlCreate(ADL_Main_Memory_Alloc, 1) == 0) {
-            int numAdapters = 0;
-            adlNumAdapters(&numAdapters);
-            if (numAdapters > 0) {
-                std::vector<AdapterInfo> infos(numAdapters);
-                if (adlGetInfo(infos.data(), sizeof(AdapterInfo) * numAdapters) == 0) {
-                    for (int i = 0; i < numAdapters; i++) {
-                        ADLPMActivity act = { 0 }; act.iSize = sizeof(ADLPMActivity);
-                        if (infos[i].iPresent && adlGetActivity && adlGetActivity(infos[i].iAdapterIndex, &act) == 0) {
-                            amdAdapterIndex = infos[i].iAdapterIndex;
+        for (auto& p : providers) p->Sample(work);
 
-                            if (adlGetMemInfo) {
-                                ADLMemoryInfo memVal = { 0 };
-                                if (adlGetMemInfo(infos[i].iAdapterIndex, &memVal) == 0) {
-                                    gpu_vram_total = (float)memVal.iMemorySize / (1024.f * 1024.f * 1024.f);
-                                }
-                            }
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-        FreeLibrary(hAdl); hAdl = nullptr;
-        return false;
+        work.sample_syscalls = (unsigned)(PlatformIoSyscalls() - syscalls);
+        work.sample_us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+        published.WriteBuffer() = work;
+        published.Publish();
     }
 
-    bool InitUniversalGPU() {
-        if (PdhOpenQuery(NULL, 0, &gpuQuery) == ERROR_SUCCESS) {
-            if (PdhAddEnglishCounter(gpuQuery, L"\\GPU Engine(*)\\Utilization Percentage", 0, &gpuCounter) != ERROR_SUCCESS) {
-                if (PdhAddCounter(gpuQuery, L"\\GPU Engine(*)\\Utilization Percentage", 0, &gpuCounter) != ERROR_SUCCESS) {
-                    PdhCloseQuery(gpuQuery);
-                    return false;
-                }
-            }
-            PdhCollectQueryData(gpuQuery);
-            pdhGpuInit = true;
-            return true;
-        }
-        return false;
+    // An early pass for a wake event: only the providers that own wake fds are
+    // sampled, so the tick-counted periods of everything else stay on the schedule.
+    void SampleWoken() {
+        for (SensorProvider* p : wakeProviders) p->Sample(work);
+        published.WriteBuffer() = work;
+        published.Publish();
     }
 
-    void MeasureGPU() {
-        float rawGpu = 0.0f;
-        float rawVramUsed = 0.0f;
-
-        if (gpuSource == SOURCE_NVIDIA) {
-            if (nvmlGetUsage) {
-                nvmlUtilization_st rates;
-                if (nvmlGetUsage(nvidiaDevice, &rates) == 0) rawGpu = (float)rates.gpu;
-            }
-            if (nvmlGetTemp) {
-                unsigned int temp = 0;
-                if (nvmlGetTemp(nvidiaDevice, 0, &temp) == 0) gpu_temp = (float)temp;
-            }
-            if (nvmlGetMem) {
-                nvmlMemory_t mem = { 0 };
-                if (nvmlGetMem(nvidiaDevice, &mem) == 0) {
-                    rawVramUsed = (float)mem.used / (1024.f * 1024.f * 1024.f);
-                }
-            }
-        }
-        else if (gpuSource == SOURCE_AMD) {
-            if (adlGetActivity) {
-                ADLPMActivity act = { 0 }; act.iSize = sizeof(ADLPMActivity);
-                if (adlGetActivity(amdAdapterIndex, &act) == 0) rawGpu = (float)act.iActivityPercent;
-            }
-        }
-        else if (gpuSource == SOURCE_PDH && pdhGpuInit) {
-            PdhCollectQueryData(gpuQuery);
-
-            DWORD dwBufferSize = 0, dwItemCount = 0;
-            PdhGetFormattedCounterArray(gpuCounter, PDH_FMT_DOUBLE, &dwBufferSize, &dwItemCount, NULL);
-
-            if (dwBufferSize > 0) {
-                if (pdhRawBuffer.size() < dwBufferSize) pdhRawBuffer.resize(dwBufferSize);
-
-                PDH_FMT_COUNTERVALUE_ITEM* pItems = (PDH_FMT_COUNTERVALUE_ITEM*)pdhRawBuffer.data();
-
-                PDH_STATUS status = PdhGetFormattedCounterArray(gpuCounter, PDH_FMT_DOUBLE, &dwBufferSize, &dwItemCount, pItems);
-
-                if (status == ERROR_SUCCESS) {
-                    double maxLoad = 0.0;
-                    for (DWORD i = 0; i < dwItemCount; i++) {
-                        if (pItems[i].FmtValue.CStatus == PDH_CSTATUS_VALID) {
-                            if (pItems[i].FmtValue.doubleValue > maxLoad) maxLoad = pItems[i].FmtValue.doubleValue;
-                        }
-                    }
-                    rawGpu = (float)maxLoad;
-                }
+    // Runs on the fixed period; a wake event (PSI trigger) inserts an extra pass
+    // right away without shifting the regular schedule.
+    void SamplerLoop() {
+        auto period = std::chrono::milliseconds(SAMPLE_PERIOD_MS);
+        auto next = std::chrono::steady_clock::now() + period;
+
+        for (;;) {
+            WakeReason reason = waiter.WaitUntil(next);
+            if (reason == WAKE_STOP) return;
+            if (reason == WAKE_EVENT) {
+                work.early_samples++;
+                SampleWoken();
+                continue;
             }
-        }
-        target_gpu = std::max(0.0f, std::min(100.0f, rawGpu));
-        gpu_vram_used = rawVramUsed;
-    }
-
-    void Update(float deltaTime) {
-        static float sensorTimer = 0.0f;
-        sensorTimer += deltaTime;
-
-        if (sensorTimer >= 0.2f) {
-            sensorTimer = 0.0f;
 
-            MeasureCPU();
-            MeasureGPU();
-
-            MEMORYSTATUSEX memInfo;
-            memInfo.dwLength = sizeof(MEMORYSTATUSEX);
-            if (GlobalMemoryStatusEx(&memInfo)) {
-                ram_usage_gb = (float)(memInfo.ullTotalPhys - memInfo.ullAvailPhys) / (1024.f * 1024.f * 1024.f);
-                target_ram_load = (float)memInfo.dwMemoryLoad;
-            }
+            SampleOnce();
+            next += period;
+            auto now = std::chrono::steady_clock::now();
+            if (next < now) next = now + period;
         }
-
-        float smoothSpeed = deltaTime * 5.0f;
-        cpu_load = Lerp(cpu_load, target_cpu, smoothSpeed);
-        gpu_load = Lerp(gpu_load, target_gpu, smoothSpeed);
-        ram_percent = Lerp(ram_percent, target_ram_load, smoothSpeed);
     }
-};
\ No newline at end of file
+};
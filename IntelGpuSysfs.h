@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+
+// Intel GPUs through the i915 / xe sysfs knobs, no perf PMU needed. Busy percent
+// is the complement of the RC6 (xe: gtidle) residency accumulated since the last tick.
+class IntelGpus {
+private:
+    struct Card {
+        ProcFile actFreq;
+        ProcFile reqFreq;
+        ProcFile idleMs;
+        ProcFile throttle;
+        uint64_t lastIdleMs = 0;
+        bool primed = false;
+        GpuDeviceStats info;
+    };
+    std::vector<Card> cards;
+    uint64_t lastNs = 0;
+
+    // First layout that exists wins: i915 per-GT, i915 legacy card-level, xe.
+    static bool OpenCard(const std::string& card, Card& c, const char*& driver) {
+        std::string gt = card + "/gt/gt0";
+        if (c.idleMs.Open((gt + "/rc6_residency_ms").c_str(), 64)) {
+            c.actFreq.Open((gt + "/rps_act_freq_mhz").c_str(), 64);
+            c.reqFreq.Open((gt + "/rps_cur_freq_mhz").c_str(), 64);
+            c.throttle.Open((gt + "/throttle_reason_status").c_str(), 64);
+            driver = "i915";
+            return true;
+        }
+        if (c.idleMs.Open((card + "/power/rc6_residency_ms").c_str(), 64)) {
+            c.actFreq.Open((card + "/gt_act_freq_mhz").c_str(), 64);
+            c.reqFreq.Open((card + "/gt_cur_freq_mhz").c_str(), 64);
+            driver = "i915";
+            return true;
+        }
+        gt = card + "/device/tile0/gt0";
+        if (c.idleMs.Open((gt + "/gtidle/idle_residency_ms").c_str(), 64)) {
+            c.actFreq.Open((gt + "/freq0/act_freq").c_str(), 64);
+            c.reqFreq.Open((gt + "/freq0/cur_freq").c_str(), 64);
+            c.throttle.Open((gt + "/freq0/throttle/status").c_str(), 64);
+            driver = "xe";
+            return true;
+        }
+        return false;
+    }
+
+    static bool ReadU64(ProcFile& f, uint64_t& v) {
+        return f.Read() && TextScanner(f).U64(v);
+    }
+
+public:
+    size_t Count() const { return cards.size(); }
+
+    bool Init() {
+        for (const std::string& name : ListDrmCards()) {
+            Card c;
+            const char* driver = "";
+            if (!OpenCard("/sys/class/drm/" + name, c, driver)) continue;
+            c.info.index = (int)cards.size();
+            snprintf(c.info.name, sizeof(c.info.name), "%s (%s)", name.c_str(), driver);
+            cards.push_back(std::move(c));
+        }
+        return !cards.empty();
+    }
+
+    void Sample(SensorSnapshot& snap) {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t nowNs = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+        double elapsedMs = (double)(nowNs - lastNs) / 1e6;
+        lastNs = nowNs;
+
+        snap.gpus.resize(cards.size());
+        for (size_t i = 0; i < cards.size(); i++) {
+            Card& c = cards[i];
+            GpuDeviceStats& d = c.info;
+            uint64_t v = 0;
+
+            if (ReadU64(c.idleMs, v)) {
+                if (c.primed && v >= c.lastIdleMs && elapsedMs > 0.0) {
+                    double idle = (double)(v - c.lastIdleMs) * 100.0 / elapsedMs;
+                    d.load = (float)(100.0 - std::min(idle, 100.0));
+                }
+                c.lastIdleMs = v;
+                c.primed = true;
+            }
+            if (ReadU64(c.actFreq, v)) d.sm_clock_mhz = (float)v;
+            if (ReadU64(c.reqFreq, v)) d.req_clock_mhz = (float)v;
+            if (ReadU64(c.throttle, v)) d.throttled = v != 0;
+
+            snap.gpus[i] = d;
+        }
+
+        AggregateGpus(snap);
+    }
+};
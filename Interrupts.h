@@ -0,0 +1,296 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+#include "SlotMap.h"
+
+// A ten-character right-aligned counter as printed by "%10u". A leading blank masks
+// to 0 exactly like a leading zero, so on little-endian hosts the low eight digits
+// fold in three multiplies instead of a per-digit loop.
+inline uint64_t Decimal10(const char* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    memcpy(&v, p + 2, 8);
+    v = ((v & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+    v = ((v & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+    v = ((v & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32;
+    return (uint64_t)((p[0] & 0xF) * 10 + (p[1] & 0xF)) * 100000000ull + v;
+#else
+    return TextScanner(p, 10).U64();
+#endif
+}
+
+// Per-source, per-CPU interrupt rates from /proc/interrupts and /proc/softirqs.
+// On a NIC-heavy many-core host /proc/interrupts is hundreds of rows by hundreds of
+// columns, so it is streamed in chunks like the socket tables and each count is
+// decoded at a fixed offset: the kernel prints every one in an 11-character column.
+// IRQs are keyed by label in a SlotMap, so MSI vectors coming and going only touch
+// their own slot. A CPU going on- or offline changes the columns and starts over.
+class InterruptProvider : public SensorProvider {
+private:
+    static const int DESC_PERIOD = 25;
+    static const size_t COLUMN = 11;
+    static constexpr float IMBALANCE_SHARE = 50.0f;
+    static constexpr float IMBALANCE_MIN_RATE = 1000.0f;
+
+    struct Irq {
+        char name[16] = { 0 };
+        uint32_t seenTick = 0;
+        IrqRate stats;
+    };
+
+    ProcStream irqFile;
+    ProcStream softFile;
+    std::vector<int> irqCpus;
+    std::vector<int> softCpus;
+    std::vector<int> header;
+    std::vector<uint64_t> row;
+
+    SlotMap index;
+    std::vector<Irq> irqs;
+    std::vector<float> irqRates;  // Capacity() rows of irqCpus.size() columns
+    RateStage irqCounters;
+    std::vector<float> softRates;
+    RateStage softCounters;
+    uint32_t tick = 0;
+
+    // "           CPU0       CPU1       CPU4" -> { 0, 1, 4 }; true if the columns changed.
+    bool ParseHeader(const char* data, size_t size, std::vector<int>& cpus) {
+        header.clear();
+        TextScanner s(data, size);
+        for (;;) {
+            s.SkipBlanks();
+            if (!s.Consume("CPU", 3)) break;
+            header.push_back((int)s.U64());
+        }
+        if (header == cpus) return false;
+        cpus.swap(header);
+        if (row.size() < cpus.size()) row.resize(cpus.size());
+        return true;
+    }
+
+    // Counts after "label:" into row[0..columns); returns where the description starts.
+    // Device IRQs print " %10u" per CPU and the architecture's own rows ": " then
+    // "%10u ", which lands on the same grid: column c is the 11 bytes at p + 11c, a
+    // blank and then ten right-aligned digits. Short rows (ERR, MIS) and anything
+    // off the grid go through the scanner instead.
+    const char* ParseCounts(const char* p, const char* end, size_t columns) {
+        size_t c = 0;
+        if ((size_t)(end - p) >= columns * COLUMN) {
+            for (; c < columns; c++) {
+                const char* f = p + c * COLUMN;
+                if (f[0] != ' ' || (unsigned)(f[COLUMN - 1] - '0') > 9) break;
+                row[c] = Decimal10(f + 1);
+            }
+            if (c == columns) return p + columns * COLUMN;
+        }
+        TextScanner s(p, (size_t)(end - p));
+        for (c = 0; c < columns && s.U64(row[c]); c++) {}
+        for (; c < columns; c++) row[c] = 0;
+        return s.Pos();
+    }
+
+    // Copies a description with leading blanks dropped and runs of blanks folded.
+    static void CopyDesc(char* out, size_t size, const char* p, const char* end) {
+        size_t n = 0;
+        bool blank = true;
+        for (; p < end && n + 1 < size; p++) {
+            bool b = *p == ' ' || *p == '\t';
+            if (b && blank) continue;
+            out[n++] = b ? ' ' : *p;
+            blank = b;
+        }
+        while (n > 0 && out[n - 1] == ' ') n--;
+        out[n] = '\0';
+    }
+
+    void RowRates(RateStage& counters, size_t base, const std::vector<int>& cpus, float* out, IrqRate& st) {
+        float sum = 0.0f, top = 0.0f;
+        int topCol = -1;
+        for (size_t c = 0; c < cpus.size(); c++) {
+            float r = counters.Rate(base + c, row[c]);
+            out[c] = r;
+            sum += r;
+            if (r > top) { top = r; topCol = (int)c; }
+        }
+        st.rate = sum;
+        st.top_cpu = topCol >= 0 ? cpus[topCol] : -1;
+        st.top_share = sum > 0.0f ? top * 100.0f / sum : 0.0f;
+    }
+
+    static bool SameName(const Irq& q, const char* name, size_t len) {
+        return len < sizeof(q.name) && memcmp(q.name, name, len) == 0 && q.name[len] == '\0';
+    }
+
+    int Discover(uint64_t key, const char* name, size_t len) {
+        size_t cols = irqCpus.size();
+        int slot = index.Insert(key);
+        if ((size_t)slot >= irqs.size()) {
+            irqs.resize(index.Capacity());
+            irqRates.resize(index.Capacity() * cols);
+            irqCounters.Resize(index.Capacity() * cols);
+        }
+        for (size_t c = 0; c < cols; c++) irqCounters.Reset((size_t)slot * cols + c);
+
+        Irq& q = irqs[slot];
+        q = Irq();
+        memcpy(q.name, name, std::min(len, sizeof(q.name) - 1));
+        memcpy(q.stats.name, q.name, sizeof(q.name));
+        return slot;
+    }
+
+    // Splits the next line off `s`; false at the end of the chunk.
+    static bool NextLine(TextScanner& s, const char*& line, const char*& end) {
+        if (s.AtEnd()) return false;
+        line = s.Pos();
+        s.SkipLine();
+        end = s.Pos();
+        if (end > line && end[-1] == '\n') end--;
+        return true;
+    }
+
+    void SampleIrqs(InterruptStats& out) {
+        if (!irqFile.Rewind()) return;
+        bool refreshDesc = tick % DESC_PERIOD == 0;
+        bool first = true;
+        const char* data;
+        size_t size;
+        while (irqFile.Next(data, size)) {
+            TextScanner s(data, size);
+            const char* line;
+            const char* end;
+            if (first) {
+                first = false;
+                if (!NextLine(s, line, end)) break;
+                if (ParseHeader(line, (size_t)(end - line), irqCpus)) {
+                    index = SlotMap();
+                    irqs.clear();
+                    irqRates.clear();
+                    irqCounters = RateStage();
+                }
+                irqCounters.Begin();
+            }
+            size_t cols = irqCpus.size();
+            while (NextLine(s, line, end)) {
+                const char* colon = (const char*)memchr(line, ':', (size_t)(end - line));
+                if (!colon) continue;
+                const char* name = line;
+                while (name < colon && *name == ' ') name++;
+                size_t len = (size_t)(colon - name);
+
+                uint64_t key = HashName(name, len);
+                int slot = index.Find(key);
+                bool fresh = slot < 0 || !SameName(irqs[slot], name, len);
+                if (fresh) slot = Discover(key, name, len);
+
+                const char* desc = ParseCounts(colon + 1, end, cols);
+                Irq& q = irqs[slot];
+                if (fresh || refreshDesc) CopyDesc(q.stats.desc, sizeof(q.stats.desc), desc, end);
+                RowRates(irqCounters, (size_t)slot * cols, irqCpus, &irqRates[(size_t)slot * cols], q.stats);
+                q.seenTick = tick;
+            }
+        }
+
+        size_t cols = irqCpus.size();
+        TopN<IRQ_TOP> top;
+        out.irq_total = 0.0f;
+        out.irq_cpus = irqCpus;
+        out.irq_cpu_rates.assign(cols, 0.0f);
+        for (size_t n = 0; n < irqs.size(); n++) {
+            if (!index.Used((int)n)) continue;
+            if (irqs[n].seenTick != tick) {
+                index.Erase((int)n);
+                continue;
+            }
+            const float* r = &irqRates[n * cols];
+            for (size_t c = 0; c < cols; c++) out.irq_cpu_rates[c] += r[c];
+            float rate = irqs[n].stats.rate;
+            out.irq_total += rate;
+            if (rate > 0.0f) top.Offer(rate, (int)n);
+        }
+
+        out.irqs.resize(top.Count());
+        out.irq_rates.resize((size_t)top.Count() * cols);
+        for (int k = 0; k < top.Count(); k++) {
+            out.irqs[k] = irqs[top[k]].stats;
+            std::copy_n(&irqRates[(size_t)top[k] * cols], cols, &out.irq_rates[(size_t)k * cols]);
+        }
+    }
+
+    void SampleSoftirqs(InterruptStats& out) {
+        if (!softFile.Rewind()) return;
+        bool first = true;
+        const char* data;
+        size_t size;
+        while (softFile.Next(data, size)) {
+            TextScanner s(data, size);
+            const char* line;
+            const char* end;
+            if (first) {
+                first = false;
+                if (!NextLine(s, line, end)) break;
+                if (ParseHeader(line, (size_t)(end - line), softCpus)) {
+                    softCounters = RateStage();
+                    softCounters.Resize(SOFTIRQ_COUNT * softCpus.size());
+                    softRates.assign(SOFTIRQ_COUNT * softCpus.size(), 0.0f);
+                }
+                softCounters.Begin();
+            }
+            size_t cols = softCpus.size();
+            while (NextLine(s, line, end)) {
+                const char* colon = (const char*)memchr(line, ':', (size_t)(end - line));
+                if (!colon) continue;
+                const char* name = line;
+                while (name < colon && *name == ' ') name++;
+                size_t len = (size_t)(colon - name);
+
+                int k = 0;
+                while (k < SOFTIRQ_COUNT && !(strlen(SOFTIRQ_NAMES[k]) == len && memcmp(SOFTIRQ_NAMES[k], name, len) == 0)) k++;
+                if (k == SOFTIRQ_COUNT) continue;
+
+                ParseCounts(colon + 1, end, cols);
+                strcpy(out.softirqs[k].name, SOFTIRQ_NAMES[k]);
+                RowRates(softCounters, (size_t)k * cols, softCpus, &softRates[(size_t)k * cols], out.softirqs[k]);
+            }
+        }
+        out.softirq_cpus = softCpus;
+        out.softirq_rates = softRates;
+
+        // /proc/softirqs lists every possible CPU; spread is judged over the online ones.
+        const IrqRate& rx = out.softirqs[SOFTIRQ_NET_RX];
+        size_t online = irqCpus.empty() ? softCpus.size() : irqCpus.size();
+        out.net_rx_cpu = rx.top_cpu;
+        out.net_rx_share = rx.top_share;
+        out.net_rx_imbalance = rx.top_share / 100.0f * (float)online;
+        out.net_rx_imbalanced = online > 1 && rx.rate >= IMBALANCE_MIN_RATE && rx.top_share >= IMBALANCE_SHARE;
+    }
+
+public:
+    const char* Name() const override { return "interrupts"; }
+
+    bool Init() override {
+        if (!irqFile.Open("/proc/interrupts")) return false;
+        softFile.Open("/proc/softirqs", 64 * 1024);
+        return true;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        tick++;
+        InterruptStats& out = snap.interrupts;
+        out.available = true;
+        SampleIrqs(out);
+        SampleSoftirqs(out);
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "irq_rate", "1/s" });
+        out.push_back({ "irq_cpu_rate", "1/s" });
+        out.push_back({ "softirq_rate", "1/s" });
+        out.push_back({ "net_rx_share", "%" });
+        out.push_back({ "net_rx_imbalance", "" });
+    }
+};
@@ -0,0 +1,322 @@
+#pragma once
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <dirent.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include "SensorProvider.h"
+#include "CpuCores.h"
+#include "ProcReader.h"
+#include "MemInfo.h"
+#include "SchedStats.h"
+#include "Nvml.h"
+#include "AmdGpuSysfs.h"
+#include "IntelGpuSysfs.h"
+#include "DrmClients.h"
+#include "ThermalSensors.h"
+#include "CpuFreqSensors.h"
+#include "CpuIdleSensors.h"
+#include "CpuTopology.h"
+#include "VmStat.h"
+#include "Psi.h"
+#include "CgroupLimits.h"
+#include "CgroupTree.h"
+#include "DiskStats.h"
+#include "NetDev.h"
+#include "Sockets.h"
+#include "Interrupts.h"
+#include "Processes.h"
+
+class LinuxSensorProvider : public SensorProvider {
+private:
+    ProcFile statFile;
+    ProcFile meminfoFile;
+    ProcFile loadavgFile;
+    SchedStatReader schedstat;
+    RateStage statRates;
+
+    unsigned long long lastIdle = 0;
+    unsigned long long lastTotal = 0;
+    bool cpuInited = false;
+    CpuCoreEngine cores;
+
+    GpuSource gpuSource = SOURCE_NONE;
+    NvmlGpus nvidia;
+    AmdGpus amd;
+    IntelGpus intel;
+
+public:
+    const char* Name() const override { return "linux"; }
+
+    bool Init() override {
+        if (!statFile.Open("/proc/stat", 16384)) return false;
+        meminfoFile.Open("/proc/meminfo", 8192);
+        loadavgFile.Open("/proc/loadavg", 256);
+        schedstat.Init();
+        statRates.Resize(2);
+
+        if (nvidia.Init()) gpuSource = SOURCE_NVIDIA;
+        else if (amd.Init()) gpuSource = SOURCE_AMD;
+        else if (intel.Init()) gpuSource = SOURCE_INTEL;
+        return true;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        MeasureCPU(snap);
+        MeasureScheduler(snap);
+        MeasureGPU(snap);
+        MeasureRAM(snap);
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "cpu_load", "%" });
+        out.push_back({ "cpu_core_load", "%" });
+        out.push_back({ "cpu_core_user", "%" });
+        out.push_back({ "cpu_core_system", "%" });
+        out.push_back({ "cpu_core_iowait", "%" });
+        out.push_back({ "cpu_core_steal", "%" });
+        out.push_back({ "ctxt", "1/s" });
+        out.push_back({ "forks", "1/s" });
+        out.push_back({ "procs_running", "" });
+        out.push_back({ "procs_blocked", "" });
+        out.push_back({ "load1", "" });
+        out.push_back({ "load5", "" });
+        out.push_back({ "load15", "" });
+        out.push_back({ "sched_latency", "ms" });
+        if (gpuSource != SOURCE_NONE) {
+            out.push_back({ "gpu_load", "%" });
+            out.push_back({ "gpu_count", "" });
+            out.push_back({ "gpu_load_mean", "%" });
+            out.push_back({ "gpu_sm_clock", "MHz" });
+        }
+        if (gpuSource == SOURCE_NVIDIA || gpuSource == SOURCE_AMD) {
+            out.push_back({ "gpu_vram_used", "GB" });
+            out.push_back({ "gpu_vram_total", "GB" });
+            out.push_back({ "gpu_temp", "C" });
+            out.push_back({ "gpu_temp_mean", "C" });
+            out.push_back({ "gpu_power", "W" });
+            out.push_back({ "gpu_mem_clock", "MHz" });
+            out.push_back({ "gpu_throttle_reasons", "mask" });
+        }
+        if (gpuSource == SOURCE_NVIDIA) {
+            out.push_back({ "gpu_pcie_tx", "MB/s" });
+            out.push_back({ "gpu_pcie_rx", "MB/s" });
+            out.push_back({ "gpu_fan", "%" });
+        }
+        if (gpuSource == SOURCE_INTEL) {
+            out.push_back({ "gpu_req_clock", "MHz" });
+            out.push_back({ "gpu_throttled", "" });
+        }
+        out.push_back({ "ram_usage_gb", "GB" });
+        out.push_back({ "ram_percent", "%" });
+        out.push_back({ "ram_total_gb", "GB" });
+        out.push_back({ "ram_used_no_cache", "GB" });
+        out.push_back({ "ram_cached", "GB" });
+        out.push_back({ "ram_buffers", "GB" });
+        out.push_back({ "ram_dirty", "MB" });
+        out.push_back({ "ram_writeback", "MB" });
+        out.push_back({ "ram_slab", "GB" });
+        out.push_back({ "ram_shmem", "GB" });
+        out.push_back({ "ram_anon_huge", "GB" });
+        out.push_back({ "swap_used", "GB" });
+        out.push_back({ "swap_total", "GB" });
+        out.push_back({ "hugepages_total", "" });
+        out.push_back({ "hugepages_free", "" });
+    }
+
+private:
+    void MeasureCPU(SensorSnapshot& snap) {
+        if (!statFile.Read()) return;
+
+        // Lines look like "cpu3 user nice system idle iowait irq softirq steal guest guest_nice";
+        // the aggregate "cpu" line comes first and the per-CPU lines follow it contiguously.
+        TextScanner s(statFile);
+        while (s.Consume("cpu", 3)) {
+            long index = -1;
+            if (s.Peek() >= '0' && s.Peek() <= '9') index = (long)s.U64();
+
+            uint64_t v[8] = { 0 };
+            for (int i = 0; i < 8; i++) s.U64(v[i]);
+            s.SkipLine();
+
+            uint64_t user = v[0] + v[1];
+            uint64_t system = v[2] + v[5] + v[6];
+            uint64_t idle = v[3];
+            uint64_t iowait = v[4];
+            uint64_t steal = v[7];
+
+            if (index < 0) {
+                MeasureAggregate(snap, idle + iowait, user + system + idle + iowait + steal);
+                continue;
+            }
+
+            if ((size_t)index >= cores.Count()) cores.Resize((size_t)index + 1);
+            CpuTimesSoA& c = cores.Current();
+            c.user[index] = user;
+            c.system[index] = system;
+            c.idle[index] = idle;
+            c.iowait[index] = iowait;
+            c.steal[index] = steal;
+        }
+
+        // The rest: intr, ctxt, btime, processes, procs_running, procs_blocked, softirq.
+        SchedStats& sched = snap.sched;
+        statRates.Begin();
+        while (!s.AtEnd()) {
+            if (s.Consume("ctxt ", 5)) sched.ctxt_per_s = statRates.Rate(0, s.U64());
+            else if (s.Consume("processes ", 10)) sched.forks_per_s = statRates.Rate(1, s.U64());
+            else if (s.Consume("procs_running ", 14)) sched.procs_running = (unsigned)s.U64();
+            else if (s.Consume("procs_blocked ", 14)) sched.procs_blocked = (unsigned)s.U64();
+            s.SkipLine();
+        }
+
+        cores.Compute(snap.cpu_cores);
+    }
+
+    void MeasureScheduler(SensorSnapshot& snap) {
+        if (loadavgFile.Read()) ParseLoadavg(loadavgFile.Data(), loadavgFile.Size(), snap.sched);
+        schedstat.Sample(snap.sched);
+    }
+
+    void MeasureAggregate(SensorSnapshot& snap, unsigned long long idleAll, unsigned long long total) {
+        if (!cpuInited) {
+            lastIdle = idleAll;
+            lastTotal = total;
+            cpuInited = true;
+            snap.cpu_load = 0.0f;
+            return;
+        }
+
+        unsigned long long idleDiff = idleAll - lastIdle;
+        unsigned long long totalDiff = total - lastTotal;
+
+        lastIdle = idleAll;
+        lastTotal = total;
+
+        if (totalDiff == 0) return;
+
+        double cpu = (1.0 - (double)idleDiff / (double)totalDiff) * 100.0;
+
+        if (cpu < 0.0) cpu = 0.0;
+        if (cpu > 100.0) cpu = 100.0;
+
+        snap.cpu_load = (float)cpu;
+    }
+
+    void MeasureRAM(SensorSnapshot& snap) {
+        uint64_t kb[MEM_KEY_COUNT];
+        if (!meminfoFile.Read() || !ParseMeminfo(meminfoFile.Data(), meminfoFile.Size(), kb)) return;
+
+        const float KB_TO_GB = 1.0f / (1024.f * 1024.f);
+        uint64_t total = kb[MEM_TOTAL];
+        uint64_t usedKb = total - std::min(kb[MEM_AVAILABLE], total);
+        snap.ram_total_gb = (float)total * KB_TO_GB;
+        snap.ram_usage_gb = (float)usedKb * KB_TO_GB;
+        snap.ram_percent = (float)usedKb * 100.0f / (float)total;
+
+        MemBreakdown& m = snap.mem;
+        m.cached_gb = (float)kb[MEM_CACHED] * KB_TO_GB;
+        m.buffers_gb = (float)kb[MEM_BUFFERS] * KB_TO_GB;
+        m.dirty_mb = (float)kb[MEM_DIRTY] / 1024.0f;
+        m.writeback_mb = (float)kb[MEM_WRITEBACK] / 1024.0f;
+        m.slab_gb = (float)kb[MEM_SLAB] * KB_TO_GB;
+        m.slab_reclaimable_gb = (float)kb[MEM_SRECLAIMABLE] * KB_TO_GB;
+        m.shmem_gb = (float)kb[MEM_SHMEM] * KB_TO_GB;
+        m.anon_huge_gb = (float)kb[MEM_ANON_HUGE_PAGES] * KB_TO_GB;
+        m.swap_total_gb = (float)kb[MEM_SWAP_TOTAL] * KB_TO_GB;
+        m.swap_used_gb = (float)(kb[MEM_SWAP_TOTAL] - std::min(kb[MEM_SWAP_FREE], kb[MEM_SWAP_TOTAL])) * KB_TO_GB;
+        m.hugepages_total = (unsigned)kb[MEM_HUGEPAGES_TOTAL];
+        m.hugepages_free = (unsigned)kb[MEM_HUGEPAGES_FREE];
+        m.hugepage_size_mb = (float)kb[MEM_HUGEPAGE_SIZE] / 1024.0f;
+        m.hugetlb_gb = (float)kb[MEM_HUGETLB] * KB_TO_GB;
+
+        // Page cache minus shmem (tmpfs cannot be dropped), buffers and reclaimable slab all go away under pressure.
+        uint64_t cache = kb[MEM_BUFFERS] + kb[MEM_CACHED] - std::min(kb[MEM_SHMEM], kb[MEM_CACHED]) + kb[MEM_SRECLAIMABLE];
+        uint64_t noCache = total - std::min(kb[MEM_FREE] + cache, total);
+        m.used_no_cache_gb = (float)noCache * KB_TO_GB;
+        m.used_no_cache_percent = (float)noCache * 100.0f / (float)total;
+    }
+
+    void MeasureGPU(SensorSnapshot& snap) {
+        snap.gpu_source = gpuSource;
+        if (gpuSource == SOURCE_NONE) return;
+        if (gpuSource == SOURCE_NVIDIA) nvidia.Sample(snap);
+        else if (gpuSource == SOURCE_AMD) amd.Sample(snap);
+        else if (gpuSource == SOURCE_INTEL) intel.Sample(snap);
+    }
+};
+
+inline uint64_t PlatformIoSyscalls() { return ProcIo().syscalls; }
+
+// Sampler sleep: poll() over an eventfd (for shutdown) plus the providers' wake fds,
+// with the next period's deadline as timeout.
+class SamplerWaiter {
+private:
+    int stopFd = -1;
+    std::atomic<bool> stopping{ false };
+    std::vector<pollfd> fds;
+
+public:
+    ~SamplerWaiter() {
+        if (stopFd >= 0) close(stopFd);
+    }
+
+    void Init(const std::vector<int>& wakeFds) {
+        stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        fds.push_back({ stopFd, POLLIN, 0 });
+        for (int fd : wakeFds) fds.push_back({ fd, POLLPRI, 0 });
+    }
+
+    WakeReason WaitUntil(std::chrono::steady_clock::time_point deadline) {
+        for (;;) {
+            if (stopping) return WAKE_STOP;
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) return WAKE_PERIOD;
+
+            // Without an eventfd, wake at least every 100 ms to notice Stop().
+            int timeout = stopFd >= 0 ? (int)left + 1 : (int)std::min<long long>(left + 1, 100);
+            int n = poll(fds.data(), (nfds_t)fds.size(), timeout);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return WAKE_PERIOD;
+            }
+            if (n == 0) continue;
+            if (fds[0].revents) return WAKE_STOP;
+
+            bool event = false;
+            for (size_t i = 1; i < fds.size(); i++) {
+                // A trigger whose file went away reports POLLERR forever; stop polling it.
+                if (fds[i].revents & (POLLERR | POLLNVAL)) fds[i].fd = -1;
+                else if (fds[i].revents & POLLPRI) event = true;
+            }
+            if (event) return WAKE_EVENT;
+        }
+    }
+
+    void Stop() {
+        stopping = true;
+        uint64_t one = 1;
+        if (stopFd >= 0 && write(stopFd, &one, sizeof(one)) < 0) {}
+    }
+};
+
+inline void CreatePlatformProviders(SensorProviderList& out) {
+    out.push_back(std::make_unique<LinuxSensorProvider>());
+    out.push_back(std::make_unique<CpuFreqProvider>());
+    out.push_back(std::make_unique<CpuIdleProvider>());
+    out.push_back(std::make_unique<CpuTopologyProvider>());
+    out.push_back(std::make_unique<VmStatProvider>());
+    out.push_back(std::make_unique<PsiProvider>());
+    out.push_back(std::make_unique<CgroupLimitProvider>());
+    out.push_back(std::make_unique<CgroupTreeProvider>());
+    out.push_back(std::make_unique<DiskStatsProvider>());
+    out.push_back(std::make_unique<NetDevProvider>());
+    out.push_back(std::make_unique<SocketTableProvider>());
+    out.push_back(std::make_unique<InterruptProvider>());
+    out.push_back(std::make_unique<ProcessProvider>());
+    out.push_back(std::make_unique<DrmClientProvider>());
+    out.push_back(std::make_unique<ThermalProvider>());
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "ProcReader.h"
+
+// /proc/meminfo keys we keep. Order matches MEM_KEY_NAMES.
+enum MemKey {
+    MEM_TOTAL, MEM_FREE, MEM_AVAILABLE, MEM_BUFFERS, MEM_CACHED, MEM_SWAP_CACHED,
+    MEM_ACTIVE, MEM_INACTIVE, MEM_DIRTY, MEM_WRITEBACK, MEM_ANON_PAGES, MEM_MAPPED,
+    MEM_SHMEM, MEM_KRECLAIMABLE, MEM_SLAB, MEM_SRECLAIMABLE, MEM_SUNRECLAIM,
+    MEM_ANON_HUGE_PAGES, MEM_SHMEM_HUGE_PAGES, MEM_SWAP_TOTAL, MEM_SWAP_FREE,
+    MEM_ZSWAP, MEM_ZSWAPPED, MEM_HUGEPAGES_TOTAL, MEM_HUGEPAGES_FREE,
+    MEM_HUGEPAGES_RSVD, MEM_HUGEPAGES_SURP, MEM_HUGEPAGE_SIZE, MEM_HUGETLB,
+    MEM_KEY_COUNT
+};
+
+constexpr const char* MEM_KEY_NAMES[MEM_KEY_COUNT] = {
+    "MemTotal", "MemFree", "MemAvailable", "Buffers", "Cached", "SwapCached",
+    "Active", "Inactive", "Dirty", "Writeback", "AnonPages", "Mapped",
+    "Shmem", "KReclaimable", "Slab", "SReclaimable", "SUnreclaim",
+    "AnonHugePages", "ShmemHugePages", "SwapTotal", "SwapFree",
+    "Zswap", "Zswapped", "HugePages_Total", "HugePages_Free",
+    "HugePages_Rsvd", "HugePages_Surp", "Hugepagesize", "Hugetlb",
+};
+
+// FNV-1a folded into a 64-slot table. The seed was searched offline so the keys
+// above land in distinct slots; the static_assert below re-checks that at build
+// time, so adding a key that collides fails to compile instead of misparsing.
+static const uint32_t MEM_HASH_SEED = 654;
+static const size_t MEM_HASH_SIZE = 64;
+
+constexpr size_t MemKeyLength(const char* s) {
+    size_t n = 0;
+    while (s[n]) n++;
+    return n;
+}
+
+constexpr size_t MemKeyHash(const char* s, size_t n) {
+    uint32_t h = MEM_HASH_SEED;
+    for (size_t i = 0; i < n; i++) h = (h ^ (unsigned char)s[i]) * 16777619u;
+    return (h >> 16) & (MEM_HASH_SIZE - 1);
+}
+
+struct MemHashTable {
+    signed char slot[MEM_HASH_SIZE];
+    bool perfect;
+};
+
+constexpr MemHashTable BuildMemHashTable() {
+    MemHashTable t = { {}, true };
+    for (size_t i = 0; i < MEM_HASH_SIZE; i++) t.slot[i] = -1;
+    for (int k = 0; k < MEM_KEY_COUNT; k++) {
+        size_t h = MemKeyHash(MEM_KEY_NAMES[k], MemKeyLength(MEM_KEY_NAMES[k]));
+        if (t.slot[h] >= 0) t.perfect = false;
+        t.slot[h] = (signed char)k;
+    }
+    return t;
+}
+
+constexpr MemHashTable MEM_HASH_TABLE = BuildMemHashTable();
+static_assert(MEM_HASH_TABLE.perfect, "meminfo key hash collides; pick a new MEM_HASH_SEED");
+
+// Returns the MemKey for a key token, or -1. One hash plus one memcmp; no allocation.
+inline int LookupMemKey(const char* key, size_t len) {
+    int k = MEM_HASH_TABLE.slot[MemKeyHash(key, len)];
+    if (k < 0) return -1;
+    const char* name = MEM_KEY_NAMES[k];
+    return (strncmp(name, key, len) == 0 && name[len] == '\0') ? k : -1;
+}
+
+// Single pass over "Key:   value kB" lines. Values are kB, except the HugePages_*
+// counts, which are page counts. Keys we do not track are skipped in place.
+inline bool ParseMeminfo(const char* data, size_t size, uint64_t (&kb)[MEM_KEY_COUNT]) {
+    memset(kb, 0, sizeof(kb));
+    TextScanner s(data, size);
+    int found = 0;
+    while (!s.AtEnd()) {
+        const char* key = s.Pos();
+        s.SkipTo(':');
+        int k = LookupMemKey(key, (size_t)(s.Pos() - key));
+        if (k >= 0 && s.Skip(':')) {
+            kb[k] = s.U64();
+            found++;
+        }
+        s.SkipLine();
+    }
+    return found > 0 && kb[MEM_TOTAL] > 0;
+}
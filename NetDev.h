@@ -0,0 +1,177 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+#include "SlotMap.h"
+
+// Per-interface throughput, packet, drop and error rates from /proc/net/dev, with
+// link speed from /sys/class/net/<if>/speed. Interfaces are keyed by a hash of
+// their name in a SlotMap, so hundreds of veths cost one probe each per tick and
+// nothing moves until one appears or goes away. Speed can change on renegotiation
+// and is re-read every SPEED_PERIOD ticks from a file kept open per physical NIC;
+// virtual interfaces (veths, bridges, bonds) are read once when they appear, so
+// hundreds of them pin no fds.
+class NetDevProvider : public SensorProvider {
+private:
+    static const int SPEED_PERIOD = 25;
+
+    // Receive: bytes packets errs drop fifo frame compressed multicast, then the same for transmit.
+    enum Field {
+        F_RX_BYTES, F_RX_PACKETS, F_RX_ERRS, F_RX_DROP, F_RX_FIFO, F_RX_FRAME, F_RX_COMPRESSED, F_RX_MULTICAST,
+        F_TX_BYTES, F_TX_PACKETS, F_TX_ERRS, F_TX_DROP, F_FIELD_COUNT
+    };
+
+    enum Counter { C_RX_BYTES, C_TX_BYTES, C_RX_PACKETS, C_TX_PACKETS, C_RX_DROP, C_TX_DROP, C_RX_ERRS, C_TX_ERRS, C_COUNTER_COUNT };
+
+    struct Interface {
+        char name[16] = { 0 };
+        bool isVirtual = false;
+        bool loopback = false;
+        bool active = false;
+        uint32_t seenTick = 0;
+        ProcFile speedFile;
+        NetInterfaceStats stats;
+    };
+
+    ProcFile file;
+    SlotMap index;
+    std::vector<Interface> interfaces;
+    RateStage rates;
+    uint32_t tick = 0;
+
+    static bool SameName(const Interface& i, const char* name, size_t len) {
+        return len < sizeof(i.name) && memcmp(i.name, name, len) == 0 && i.name[len] == '\0';
+    }
+
+    // Speed is in Mbit/s; unknown (virtual, link down) reads as -1 or fails with EINVAL.
+    static float ReadSpeed(ProcFile& f) {
+        if (!f.Read()) return 0.0f;
+        TextScanner s(f);
+        int64_t v = s.I64();
+        return v > 0 ? (float)v : 0.0f;
+    }
+
+    int Discover(uint64_t key, const char* name, size_t len) {
+        int slot = index.Insert(key);
+        if ((size_t)slot >= interfaces.size()) {
+            interfaces.resize(index.Capacity());
+            rates.Resize(index.Capacity() * C_COUNTER_COUNT);
+        }
+        for (int k = 0; k < C_COUNTER_COUNT; k++) rates.Reset((size_t)slot * C_COUNTER_COUNT + k);
+
+        Interface& i = interfaces[slot];
+        i.speedFile.Close();
+        i.stats = NetInterfaceStats();
+        i.active = false;
+        memset(i.name, 0, sizeof(i.name));
+        memcpy(i.name, name, std::min(len, sizeof(i.name) - 1));
+        memcpy(i.stats.name, i.name, sizeof(i.name));
+
+        char path[80];
+        snprintf(path, sizeof(path), "/sys/class/net/%s/device", i.name);
+        i.isVirtual = !SysExists(path);
+        i.loopback = strcmp(i.name, "lo") == 0;
+        i.stats.is_virtual = i.isVirtual;
+        snprintf(path, sizeof(path), "/sys/class/net/%s/speed", i.name);
+        if (i.speedFile.Open(path, 32)) i.stats.speed_mbit = ReadSpeed(i.speedFile);
+        if (i.isVirtual) i.speedFile.Close();
+        return slot;
+    }
+
+    void Update(int slot, const uint64_t (&f)[F_FIELD_COUNT], bool refreshSpeed) {
+        Interface& i = interfaces[slot];
+        NetInterfaceStats& st = i.stats;
+        size_t base = (size_t)slot * C_COUNTER_COUNT;
+
+        if (refreshSpeed && i.speedFile.IsOpen()) st.speed_mbit = ReadSpeed(i.speedFile);
+        st.rx_mbit = rates.Rate(base + C_RX_BYTES, f[F_RX_BYTES]) * 8.0f / 1e6f;
+        st.tx_mbit = rates.Rate(base + C_TX_BYTES, f[F_TX_BYTES]) * 8.0f / 1e6f;
+        st.rx_packets = rates.Rate(base + C_RX_PACKETS, f[F_RX_PACKETS]);
+        st.tx_packets = rates.Rate(base + C_TX_PACKETS, f[F_TX_PACKETS]);
+        st.rx_drops = rates.Rate(base + C_RX_DROP, f[F_RX_DROP]);
+        st.tx_drops = rates.Rate(base + C_TX_DROP, f[F_TX_DROP]);
+        st.rx_errors = rates.Rate(base + C_RX_ERRS, f[F_RX_ERRS]);
+        st.tx_errors = rates.Rate(base + C_TX_ERRS, f[F_TX_ERRS]);
+        st.link_percent = st.speed_mbit > 0.0f ? std::min(100.0f, std::max(st.rx_mbit, st.tx_mbit) * 100.0f / st.speed_mbit) : 0.0f;
+
+        i.active = i.active || f[F_RX_PACKETS] + f[F_TX_PACKETS] > 0;
+        i.seenTick = tick;
+    }
+
+public:
+    const char* Name() const override { return "netdev"; }
+
+    bool Init() override {
+        return file.Open("/proc/net/dev", 16384);
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        if (!file.Read()) return;
+        bool refreshSpeed = tick % SPEED_PERIOD == 0;
+        tick++;
+        rates.Begin();
+
+        TextScanner s(file);
+        s.SkipLine();
+        s.SkipLine();
+        while (!s.AtEnd()) {
+            s.SkipBlanks();
+            const char* name = s.Pos();
+            s.SkipTo(':');
+            size_t len = (size_t)(s.Pos() - name);
+            if (!s.Skip(':')) break;
+
+            uint64_t f[F_FIELD_COUNT] = { 0 };
+            for (int k = 0; k < F_FIELD_COUNT; k++) s.U64(f[k]);
+            s.SkipLine();
+
+            uint64_t key = HashName(name, len);
+            int slot = index.Find(key);
+            if (slot < 0 || !SameName(interfaces[slot], name, len)) slot = Discover(key, name, len);
+            Update(slot, f, refreshSpeed);
+        }
+
+        snap.nets.clear();
+        NetAggregate agg;
+        for (size_t n = 0; n < interfaces.size(); n++) {
+            Interface& i = interfaces[n];
+            if (!index.Used((int)n)) continue;
+            if (i.seenTick != tick) {
+                i.speedFile.Close();
+                index.Erase((int)n);
+                continue;
+            }
+            if (i.loopback || !i.active) continue;
+            snap.nets.push_back(i.stats);
+
+            if (i.isVirtual) continue;
+            const NetInterfaceStats& st = i.stats;
+            agg.count++;
+            agg.rx_mbit += st.rx_mbit;
+            agg.tx_mbit += st.tx_mbit;
+            agg.drops += st.rx_drops + st.tx_drops;
+            agg.errors += st.rx_errors + st.tx_errors;
+            if (agg.busiest < 0 || st.link_percent > agg.link_percent_max) {
+                agg.link_percent_max = st.link_percent;
+                agg.busiest = (int)snap.nets.size() - 1;
+            }
+        }
+        snap.net_agg = agg;
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "net_rx", "Mbit/s" });
+        out.push_back({ "net_tx", "Mbit/s" });
+        out.push_back({ "net_rx_packets", "1/s" });
+        out.push_back({ "net_tx_packets", "1/s" });
+        out.push_back({ "net_drops", "1/s" });
+        out.push_back({ "net_errors", "1/s" });
+        out.push_back({ "net_speed", "Mbit/s" });
+        out.push_back({ "net_link", "%" });
+    }
+};
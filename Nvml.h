@@ -0,0 +1,298 @@
+#pragma once
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include "SensorProvider.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+typedef struct nvmlDevice_st* nvmlDevice_t;
+typedef struct nvmlUtilization_st { unsigned int gpu; unsigned int memory; } nvmlUtilization_t;
+typedef struct nvmlMemory_st { unsigned long long total; unsigned long long free; unsigned long long used; } nvmlMemory_t;
+
+typedef union nvmlValue_st {
+    double dVal; int siVal; unsigned int uiVal; unsigned long ulVal;
+    unsigned long long ullVal; signed long long sllVal; unsigned short usVal;
+} nvmlValue_t;
+typedef struct nvmlSample_st { unsigned long long timeStamp; nvmlValue_t sampleValue; } nvmlSample_t;
+
+enum NvmlSamplingType {
+    NVML_TOTAL_POWER_SAMPLES = 0,
+    NVML_PROCESSOR_CLK_SAMPLES = 5,
+    NVML_MEMORY_CLK_SAMPLES = 6,
+};
+enum NvmlValueType { NVML_VALUE_DOUBLE, NVML_VALUE_UINT, NVML_VALUE_ULONG, NVML_VALUE_ULONGLONG, NVML_VALUE_SLONGLONG, NVML_VALUE_SINT, NVML_VALUE_USHORT };
+enum NvmlClockType { NVML_CLOCK_GRAPHICS = 0, NVML_CLOCK_SM = 1, NVML_CLOCK_MEM = 2 };
+enum NvmlPcieCounter { NVML_PCIE_UTIL_TX_BYTES = 0, NVML_PCIE_UTIL_RX_BYTES = 1 };
+
+static const unsigned long long NVML_THROTTLE_GPU_IDLE = 0x1ULL;
+static const unsigned long long NVML_THROTTLE_APP_CLOCKS = 0x2ULL;
+static const unsigned long long NVML_THROTTLE_SW_POWER_CAP = 0x4ULL;
+static const unsigned long long NVML_THROTTLE_HW_SLOWDOWN = 0x8ULL;
+static const unsigned long long NVML_THROTTLE_SYNC_BOOST = 0x10ULL;
+static const unsigned long long NVML_THROTTLE_SW_THERMAL = 0x20ULL;
+static const unsigned long long NVML_THROTTLE_HW_THERMAL = 0x40ULL;
+static const unsigned long long NVML_THROTTLE_HW_POWER_BRAKE = 0x80ULL;
+// Reasons that actually cost performance (idle / app-clock / sync-boost are benign).
+static const unsigned long long NVML_THROTTLE_LIMITING = NVML_THROTTLE_SW_POWER_CAP | NVML_THROTTLE_HW_SLOWDOWN |
+    NVML_THROTTLE_SW_THERMAL | NVML_THROTTLE_HW_THERMAL | NVML_THROTTLE_HW_POWER_BRAKE;
+
+static const int NVML_ERROR_NOT_FOUND = 6;
+
+typedef int(*nvmlInit_t)();
+typedef int(*nvmlShutdown_t)();
+typedef int(*nvmlDeviceGetCount_t)(unsigned int*);
+typedef int(*nvmlDeviceGetHandleByIndex_t)(unsigned int, nvmlDevice_t*);
+typedef int(*nvmlDeviceGetName_t)(nvmlDevice_t, char*, unsigned int);
+typedef int(*nvmlDeviceGetUtilizationRates_t)(nvmlDevice_t, nvmlUtilization_st*);
+typedef int(*nvmlDeviceGetTemperature_t)(nvmlDevice_t, int, unsigned int*);
+typedef int(*nvmlDeviceGetMemoryInfo_t)(nvmlDevice_t, nvmlMemory_t*);
+typedef int(*nvmlDeviceGetSamples_t)(nvmlDevice_t, int, unsigned long long, int*, unsigned int*, nvmlSample_t*);
+typedef int(*nvmlDeviceGetPowerUsage_t)(nvmlDevice_t, unsigned int*);
+typedef int(*nvmlDeviceGetClockInfo_t)(nvmlDevice_t, int, unsigned int*);
+typedef int(*nvmlDeviceGetPcieThroughput_t)(nvmlDevice_t, int, unsigned int*);
+typedef int(*nvmlDeviceGetFanSpeed_t)(nvmlDevice_t, unsigned int*);
+typedef int(*nvmlDeviceGetClocksThrottleReasons_t)(nvmlDevice_t, unsigned long long*);
+
+// Loads NVML the same way on both platforms: nvml.dll via LoadLibrary on Windows,
+// libnvidia-ml.so.1 via dlopen elsewhere. $HWMON_NVML_LIB overrides the library
+// path, which is how a stand-in NVML with scripted values is plugged in.
+class NvmlLibrary {
+private:
+#ifdef _WIN32
+    HMODULE handle = nullptr;
+#else
+    void* handle = nullptr;
+#endif
+
+public:
+    ~NvmlLibrary() { Unload(); }
+
+    bool Load() {
+        const char* overridePath = getenv("HWMON_NVML_LIB");
+#ifdef _WIN32
+        if (overridePath) handle = LoadLibraryA(overridePath);
+        if (!handle) handle = LoadLibrary(L"nvml.dll");
+        if (!handle) handle = LoadLibrary(L"C:\\Program Files\\NVIDIA Corporation\\NVSMI\\nvml.dll");
+#else
+        if (overridePath) handle = dlopen(overridePath, RTLD_NOW | RTLD_LOCAL);
+        if (!handle) handle = dlopen("libnvidia-ml.so.1", RTLD_NOW | RTLD_LOCAL);
+        if (!handle) handle = dlopen("libnvidia-ml.so", RTLD_NOW | RTLD_LOCAL);
+#endif
+        return handle != nullptr;
+    }
+
+    void Unload() {
+        if (!handle) return;
+#ifdef _WIN32
+        FreeLibrary(handle);
+#else
+        dlclose(handle);
+#endif
+        handle = nullptr;
+    }
+
+    template <typename T>
+    T Get(const char* name) const {
+        if (!handle) return nullptr;
+#ifdef _WIN32
+        return (T)GetProcAddress(handle, name);
+#else
+        return (T)dlsym(handle, name);
+#endif
+    }
+};
+
+inline double NvmlSampleValue(int type, const nvmlValue_t& v) {
+    switch (type) {
+    case NVML_VALUE_DOUBLE: return v.dVal;
+    case NVML_VALUE_UINT: return (double)v.uiVal;
+    case NVML_VALUE_ULONG: return (double)v.ulVal;
+    case NVML_VALUE_ULONGLONG: return (double)v.ullVal;
+    case NVML_VALUE_SLONGLONG: return (double)v.sllVal;
+    case NVML_VALUE_SINT: return (double)v.siVal;
+    case NVML_VALUE_USHORT: return (double)v.usVal;
+    }
+    return 0.0;
+}
+
+// Every NVIDIA device on the box, sampled in one pass per tick.
+class NvmlGpus {
+private:
+    // Power and clocks come from NVML's driver-side sample ring: one call returns
+    // everything buffered since the last timestamp we saw, averaged here.
+    static const int SAMPLED_METRICS = 3;
+    static constexpr int sampledTypes[SAMPLED_METRICS] = {
+        NVML_TOTAL_POWER_SAMPLES, NVML_PROCESSOR_CLK_SAMPLES, NVML_MEMORY_CLK_SAMPLES
+    };
+
+    NvmlLibrary lib;
+    bool initialized = false;
+    std::vector<nvmlDevice_t> devices;
+    std::vector<GpuDeviceStats> info;
+    std::vector<unsigned long long> lastSeen;
+    std::vector<nvmlSample_t> sampleBuf;
+    size_t pcieCursor = 0;
+
+    nvmlDeviceGetUtilizationRates_t nvmlGetUsage = nullptr;
+    nvmlDeviceGetTemperature_t nvmlGetTemp = nullptr;
+    nvmlDeviceGetMemoryInfo_t nvmlGetMem = nullptr;
+    nvmlDeviceGetSamples_t nvmlGetSamples = nullptr;
+    nvmlDeviceGetPowerUsage_t nvmlGetPower = nullptr;
+    nvmlDeviceGetClockInfo_t nvmlGetClock = nullptr;
+    nvmlDeviceGetPcieThroughput_t nvmlGetPcie = nullptr;
+    nvmlDeviceGetFanSpeed_t nvmlGetFan = nullptr;
+    nvmlDeviceGetClocksThrottleReasons_t nvmlGetThrottle = nullptr;
+
+public:
+    ~NvmlGpus() {
+        if (initialized) {
+            auto nvmlShutdown = lib.Get<nvmlShutdown_t>("nvmlShutdown");
+            if (nvmlShutdown) nvmlShutdown();
+        }
+    }
+
+    size_t Count() const { return devices.size(); }
+
+    bool Init() {
+        if (!lib.Load()) return false;
+
+        auto nvmlInit = lib.Get<nvmlInit_t>("nvmlInit_v2");
+        if (!nvmlInit) nvmlInit = lib.Get<nvmlInit_t>("nvmlInit");
+        auto nvmlGetCount = lib.Get<nvmlDeviceGetCount_t>("nvmlDeviceGetCount_v2");
+        if (!nvmlGetCount) nvmlGetCount = lib.Get<nvmlDeviceGetCount_t>("nvmlDeviceGetCount");
+        auto nvmlGetHandle = lib.Get<nvmlDeviceGetHandleByIndex_t>("nvmlDeviceGetHandleByIndex_v2");
+        auto nvmlGetName = lib.Get<nvmlDeviceGetName_t>("nvmlDeviceGetName");
+
+        nvmlGetUsage = lib.Get<nvmlDeviceGetUtilizationRates_t>("nvmlDeviceGetUtilizationRates");
+        nvmlGetTemp = lib.Get<nvmlDeviceGetTemperature_t>("nvmlDeviceGetTemperature");
+        nvmlGetMem = lib.Get<nvmlDeviceGetMemoryInfo_t>("nvmlDeviceGetMemoryInfo");
+        nvmlGetSamples = lib.Get<nvmlDeviceGetSamples_t>("nvmlDeviceGetSamples");
+        nvmlGetPower = lib.Get<nvmlDeviceGetPowerUsage_t>("nvmlDeviceGetPowerUsage");
+        nvmlGetClock = lib.Get<nvmlDeviceGetClockInfo_t>("nvmlDeviceGetClockInfo");
+        nvmlGetPcie = lib.Get<nvmlDeviceGetPcieThroughput_t>("nvmlDeviceGetPcieThroughput");
+        nvmlGetFan = lib.Get<nvmlDeviceGetFanSpeed_t>("nvmlDeviceGetFanSpeed");
+        nvmlGetThrottle = lib.Get<nvmlDeviceGetClocksThrottleReasons_t>("nvmlDeviceGetCurrentClocksEventReasons");
+        if (!nvmlGetThrottle) nvmlGetThrottle = lib.Get<nvmlDeviceGetClocksThrottleReasons_t>("nvmlDeviceGetCurrentClocksThrottleReasons");
+
+        if (!nvmlInit || !nvmlGetCount || !nvmlGetHandle || !nvmlGetUsage || nvmlInit() != 0) {
+            lib.Unload();
+            return false;
+        }
+        initialized = true;
+
+        unsigned int count = 0;
+        if (nvmlGetCount(&count) != 0) count = 0;
+
+        for (unsigned int i = 0; i < count; i++) {
+            nvmlDevice_t dev = nullptr;
+            if (nvmlGetHandle(i, &dev) != 0) continue;
+
+            GpuDeviceStats d;
+            d.index = (int)i;
+            if (nvmlGetName) nvmlGetName(dev, d.name, sizeof(d.name));
+            if (nvmlGetMem) {
+                nvmlMemory_t mem = { 0 };
+                if (nvmlGetMem(dev, &mem) == 0) d.vram_total_gb = (float)mem.total / (1024.f * 1024.f * 1024.f);
+            }
+            devices.push_back(dev);
+            info.push_back(d);
+        }
+
+        lastSeen.assign(devices.size() * SAMPLED_METRICS, 0);
+        if (nvmlGetSamples && !devices.empty()) {
+            unsigned int capacity = 0;
+            for (int t = 0; t < SAMPLED_METRICS; t++) {
+                int valType = 0;
+                unsigned int n = 0;
+                if (nvmlGetSamples(devices[0], sampledTypes[t], 0, &valType, &n, nullptr) == 0) capacity = std::max(capacity, n);
+            }
+            if (capacity > 0) sampleBuf.resize(capacity);
+            else nvmlGetSamples = nullptr;
+        }
+        return !devices.empty();
+    }
+
+    void Sample(SensorSnapshot& snap) {
+        snap.gpus.resize(devices.size());
+
+        for (size_t i = 0; i < devices.size(); i++) {
+            GpuDeviceStats& d = info[i];
+
+            nvmlUtilization_st rates;
+            if (nvmlGetUsage(devices[i], &rates) == 0) {
+                d.load = (float)rates.gpu;
+                d.mem_load = (float)rates.memory;
+            }
+            if (nvmlGetTemp) {
+                unsigned int temp = 0;
+                if (nvmlGetTemp(devices[i], 0, &temp) == 0) d.temp = (float)temp;
+            }
+            if (nvmlGetMem) {
+                nvmlMemory_t mem = { 0 };
+                if (nvmlGetMem(devices[i], &mem) == 0) d.vram_used_gb = (float)mem.used / (1024.f * 1024.f * 1024.f);
+            }
+
+            SamplePowerAndClocks(i, d);
+
+            if (nvmlGetFan) {
+                unsigned int fan = 0;
+                if (nvmlGetFan(devices[i], &fan) == 0) d.fan_percent = (float)fan;
+            }
+            if (nvmlGetThrottle) {
+                unsigned long long reasons = 0;
+                if (nvmlGetThrottle(devices[i], &reasons) == 0) {
+                    d.throttle_reasons = reasons;
+                    d.throttled = (reasons & NVML_THROTTLE_LIMITING) != 0;
+                }
+            }
+        }
+
+        // nvmlDeviceGetPcieThroughput integrates over ~20 ms inside the driver, so
+        // refresh one device per tick rather than stalling the pass on every card.
+        if (nvmlGetPcie && !devices.empty()) {
+            size_t i = pcieCursor++ % devices.size();
+            unsigned int kbps = 0;
+            if (nvmlGetPcie(devices[i], NVML_PCIE_UTIL_TX_BYTES, &kbps) == 0) info[i].pcie_tx_mbps = (float)kbps / 1024.0f;
+            if (nvmlGetPcie(devices[i], NVML_PCIE_UTIL_RX_BYTES, &kbps) == 0) info[i].pcie_rx_mbps = (float)kbps / 1024.0f;
+        }
+
+        std::copy(info.begin(), info.end(), snap.gpus.begin());
+        AggregateGpus(snap);
+    }
+
+private:
+    void SamplePowerAndClocks(size_t i, GpuDeviceStats& d) {
+        float* targets[SAMPLED_METRICS] = { &d.power_w, &d.sm_clock_mhz, &d.mem_clock_mhz };
+        const float scale[SAMPLED_METRICS] = { 0.001f, 1.0f, 1.0f };
+
+        for (int t = 0; t < SAMPLED_METRICS; t++) {
+            if (nvmlGetSamples) {
+                unsigned long long& seen = lastSeen[i * SAMPLED_METRICS + t];
+                int valType = 0;
+                unsigned int n = (unsigned int)sampleBuf.size();
+                int rc = nvmlGetSamples(devices[i], sampledTypes[t], seen, &valType, &n, sampleBuf.data());
+                if (rc == 0 && n > 0) {
+                    double sum = 0.0;
+                    for (unsigned int k = 0; k < n; k++) {
+                        sum += NvmlSampleValue(valType, sampleBuf[k].sampleValue);
+                        seen = std::max(seen, sampleBuf[k].timeStamp);
+                    }
+                    *targets[t] = (float)(sum / n) * scale[t];
+                    continue;
+                }
+                // No new samples since last tick: keep the previous average.
+                if (rc == NVML_ERROR_NOT_FOUND) continue;
+            }
+
+            unsigned int v = 0;
+            if (t == 0 && nvmlGetPower && nvmlGetPower(devices[i], &v) == 0) *targets[t] = (float)v * scale[t];
+            if (t == 1 && nvmlGetClock && nvmlGetClock(devices[i], NVML_CLOCK_SM, &v) == 0) *targets[t] = (float)v;
+            if (t == 2 && nvmlGetClock && nvmlGetClock(devices[i], NVML_CLOCK_MEM, &v) == 0) *targets[t] = (float)v;
+        }
+    }
+};
@@ -0,0 +1,614 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+// Syscall accounting for everything that goes through ProcFile. Only the sampler
+// thread touches these, so plain counters are enough.
+struct ProcIoStats {
+    uint64_t syscalls = 0;
+    uint64_t bytes = 0;
+    uint64_t opens = 0;
+    uint64_t grows = 0;
+};
+
+inline ProcIoStats& ProcIo() {
+    static ProcIoStats stats;
+    return stats;
+}
+
+// Prefix prepended to every /proc and /sys path the Linux providers touch, so they
+// can be pointed at a captured snapshot tree (see capture_sysroot.sh). Defaults to
+// $HWMON_SYSROOT; empty means the live system. Set it before constructing Hardware.
+inline std::string& SysRoot() {
+    static std::string root = [] {
+        const char* env = getenv("HWMON_SYSROOT");
+        std::string r = env ? env : "";
+        while (!r.empty() && r.back() == '/') r.pop_back();
+        return r;
+    }();
+    return root;
+}
+
+inline void SetSysRoot(const char* root) {
+    SysRoot() = root ? root : "";
+    while (!SysRoot().empty() && SysRoot().back() == '/') SysRoot().pop_back();
+}
+
+inline std::string SysPath(const char* path) {
+    return SysRoot() + path;
+}
+
+inline DIR* OpenSysDir(const char* path) {
+    if (SysRoot().empty()) return opendir(path);
+    return opendir(SysPath(path).c_str());
+}
+
+// Init/discovery-time existence check for a sysfs attribute or link.
+inline bool SysExists(const char* path) {
+    ProcIo().syscalls++;
+    return access(SysRoot().empty() ? path : SysPath(path).c_str(), F_OK) == 0;
+}
+
+// Name of the kernel driver bound to a sysfs device directory: the basename of
+// its "driver" link, or "" when nothing is bound.
+inline std::string SysDriver(const char* device) {
+    std::string link = SysPath(device) + "/driver";
+    char target[256];
+    ProcIo().syscalls++;
+    ssize_t n = readlink(link.c_str(), target, sizeof(target) - 1);
+    if (n <= 0) return std::string();
+    target[n] = '\0';
+    const char* base = strrchr(target, '/');
+    return base ? base + 1 : target;
+}
+
+// The DRM card directories under /sys/class/drm ("card0", "card1", ...) in card
+// order; connector entries such as "card0-DP-1" are skipped.
+inline std::vector<std::string> ListDrmCards() {
+    std::vector<std::string> names;
+    DIR* dir = OpenSysDir("/sys/class/drm");
+    if (!dir) return names;
+    while (dirent* e = readdir(dir)) {
+        if (strncmp(e->d_name, "card", 4) != 0 || strchr(e->d_name, '-')) continue;
+        names.push_back(e->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end(), [](const std::string& a, const std::string& b) {
+        return atoi(a.c_str() + 4) < atoi(b.c_str() + 4);
+    });
+    return names;
+}
+
+// Providers that pin one fd per CPU can exceed the default soft limit of 1024 on
+// large machines; lift it to the hard limit once before opening them.
+inline void RaiseFdLimit() {
+    static bool raised = false;
+    if (raised) return;
+    raised = true;
+    rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+}
+
+// Every fd held by a ProcFile, ProcStream or SysValueSet is counted here, so the
+// per-CPU sets, PSI triggers, NIC speed files and DRM fdinfo fds are all seen.
+// The budget is the soft limit after RaiseFdLimit() less headroom for fds opened
+// elsewhere. Providers that pin fds per discovered object (cgroup leaves,
+// processes) claim them with Acquire() and may hold at most their share of what
+// the other fds leave free; past that, or once those grow into it (Over()), they
+// open, read and close on every tick instead.
+class FdBudget {
+private:
+    static const size_t HEADROOM = 512;
+    size_t limit = SIZE_MAX;
+    size_t open = 0;
+    size_t claimed = 0;
+
+    size_t Cap(float share) const {
+        if (limit == SIZE_MAX) return SIZE_MAX;
+        size_t other = open > claimed ? open - claimed : 0;
+        return other < limit ? (size_t)((double)(limit - other) * share) : 0;
+    }
+
+public:
+    FdBudget() {
+        RaiseFdLimit();
+        rlimit lim;
+        if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur != RLIM_INFINITY) {
+            limit = lim.rlim_cur > HEADROOM * 2 ? (size_t)lim.rlim_cur - HEADROOM : (size_t)lim.rlim_cur / 2;
+        }
+    }
+
+    size_t Limit() const { return limit; }
+    size_t Used() const { return open; }
+
+    void Opened() { open++; }
+    void Closed() { open--; }
+
+    // Claims `n` fds for a provider currently holding `held`; false if opening them
+    // would exceed the budget or `share` of it for the provider.
+    bool Acquire(size_t& held, size_t n, float share) {
+        if (open + n > limit || held + n > Cap(share)) return false;
+        claimed += n;
+        held += n;
+        return true;
+    }
+
+    void Release(size_t& held, size_t n) {
+        claimed -= n;
+        held -= n;
+    }
+
+    // True when a provider holding `held` should give pinned fds back.
+    bool Over(size_t held, float share) const {
+        return held > 0 && (open > limit || held > Cap(share));
+    }
+};
+
+inline FdBudget& PinnedFds() {
+    static FdBudget budget;
+    return budget;
+}
+
+// A procfs/sysfs file kept open for the lifetime of the provider. Each Read() is a
+// single pread(fd, buf, cap, 0) into a buffer that only grows when a read fills it,
+// so steady-state sampling does one syscall and no allocation per file.
+class ProcFile {
+private:
+    int fd = -1;
+    std::vector<char> buf;
+    size_t len = 0;
+
+public:
+    ProcFile() {}
+    ProcFile(const ProcFile&) = delete;
+    ProcFile& operator=(const ProcFile&) = delete;
+    ProcFile(ProcFile&& o) noexcept : fd(o.fd), buf(std::move(o.buf)), len(o.len) { o.fd = -1; o.len = 0; }
+    ProcFile& operator=(ProcFile&& o) noexcept {
+        if (this != &o) {
+            Close();
+            fd = o.fd; buf = std::move(o.buf); len = o.len;
+            o.fd = -1; o.len = 0;
+        }
+        return *this;
+    }
+    ~ProcFile() { Close(); }
+
+    // `path` is an absolute /proc or /sys path; SysRoot() is applied here.
+    bool Open(const char* path, size_t capacity = 4096) {
+        Close();
+        fd = SysRoot().empty() ? open(path, O_RDONLY | O_CLOEXEC) : open(SysPath(path).c_str(), O_RDONLY | O_CLOEXEC);
+        ProcIo().syscalls++;
+        ProcIo().opens++;
+        if (fd < 0) return false;
+        PinnedFds().Opened();
+        if (buf.size() < capacity) buf.resize(capacity);
+        return true;
+    }
+
+    void Close() {
+        if (fd >= 0) {
+            close(fd);
+            PinnedFds().Closed();
+        }
+        fd = -1;
+        len = 0;
+    }
+
+    bool IsOpen() const { return fd >= 0; }
+
+    // Re-reads the whole file from offset 0. Content larger than the buffer makes it
+    // grow once and retry; after that the file fits in a single pread.
+    bool Read() {
+        if (fd < 0) return false;
+        for (;;) {
+            ssize_t n = pread(fd, buf.data(), buf.size(), 0);
+            ProcIo().syscalls++;
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                len = 0;
+                return false;
+            }
+            if ((size_t)n < buf.size()) {
+                len = (size_t)n;
+                ProcIo().bytes += len;
+                return true;
+            }
+            buf.resize(buf.size() * 2);
+            ProcIo().grows++;
+        }
+    }
+
+    const char* Data() const { return buf.data(); }
+    size_t Size() const { return len; }
+};
+
+// Sequential reader for seq_file tables too large to hold at once (/proc/net/tcp
+// with 100k+ sockets). Rewind() then Next() hands out runs of whole lines from a
+// fixed buffer; a partial trailing line is carried into the next read. Reads must
+// stay sequential: a pread at an offset makes seq_file re-walk the table from the
+// start, which is quadratic.
+class ProcStream {
+private:
+    int fd = -1;
+    std::vector<char> buf;
+    size_t start = 0;
+    size_t len = 0;
+    bool eof = false;
+
+public:
+    ProcStream() {}
+    ProcStream(const ProcStream&) = delete;
+    ProcStream& operator=(const ProcStream&) = delete;
+    ~ProcStream() { Close(); }
+
+    bool Open(const char* path, size_t chunk = 256 * 1024) {
+        Close();
+        fd = SysRoot().empty() ? open(path, O_RDONLY | O_CLOEXEC) : open(SysPath(path).c_str(), O_RDONLY | O_CLOEXEC);
+        ProcIo().syscalls++;
+        ProcIo().opens++;
+        if (fd < 0) return false;
+        PinnedFds().Opened();
+        if (buf.size() < chunk) buf.resize(chunk);
+        return true;
+    }
+
+    void Close() {
+        if (fd >= 0) {
+            close(fd);
+            PinnedFds().Closed();
+        }
+        fd = -1;
+    }
+
+    bool IsOpen() const { return fd >= 0; }
+
+    bool Rewind() {
+        start = len = 0;
+        eof = false;
+        ProcIo().syscalls++;
+        return fd >= 0 && lseek(fd, 0, SEEK_SET) == 0;
+    }
+
+    // Next run of complete lines; false once the file is exhausted.
+    bool Next(const char*& data, size_t& size) {
+        if (start > 0) {
+            memmove(buf.data(), buf.data() + start, len - start);
+            len -= start;
+            start = 0;
+        }
+        while (!eof) {
+            if (len == buf.size()) {
+                buf.resize(buf.size() * 2);
+                ProcIo().grows++;
+            }
+            ssize_t n = read(fd, buf.data() + len, buf.size() - len);
+            ProcIo().syscalls++;
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                eof = true;
+                break;
+            }
+            len += (size_t)n;
+            ProcIo().bytes += (size_t)n;
+
+            const char* last = (const char*)memrchr(buf.data(), '\n', len);
+            if (last) {
+                data = buf.data();
+                size = (size_t)(last - buf.data()) + 1;
+                start = size;
+                return true;
+            }
+        }
+        // Whatever is left is a final line without a newline.
+        data = buf.data();
+        size = len;
+        start = len;
+        return size > 0;
+    }
+};
+
+// A directory kept open and re-listed in place: Rewind() then Next() walks the
+// entries straight out of getdents64 records in a fixed buffer, with none of the
+// DIR* allocation of opendir(). Used where the listing itself is sampled every tick
+// (the pids under /proc).
+class ProcDir {
+private:
+    int fd = -1;
+    std::vector<char> buf;
+    size_t start = 0;
+    size_t len = 0;
+
+public:
+    ProcDir() {}
+    ProcDir(const ProcDir&) = delete;
+    ProcDir& operator=(const ProcDir&) = delete;
+    ~ProcDir() { Close(); }
+
+    bool Open(const char* path, size_t capacity = 64 * 1024) {
+        Close();
+        const char* p = path;
+        std::string rooted;
+        if (!SysRoot().empty()) p = (rooted = SysPath(path)).c_str();
+        fd = open(p, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        ProcIo().syscalls++;
+        ProcIo().opens++;
+        if (fd < 0) return false;
+        if (buf.size() < capacity) buf.resize(capacity);
+        return true;
+    }
+
+    void Close() {
+        if (fd >= 0) close(fd);
+        fd = -1;
+        start = len = 0;
+    }
+
+    bool IsOpen() const { return fd >= 0; }
+    int Fd() const { return fd; }
+
+    bool Rewind() {
+        start = len = 0;
+        ProcIo().syscalls++;
+        return fd >= 0 && lseek(fd, 0, SEEK_SET) == 0;
+    }
+
+    // Next entry name (NUL-terminated, valid until the following call); false at the end.
+    bool Next(const char*& name) {
+        if (start >= len) {
+            long n;
+            do {
+                n = syscall(SYS_getdents64, fd, buf.data(), buf.size());
+                ProcIo().syscalls++;
+            } while (n < 0 && errno == EINTR);
+            if (n <= 0) return false;
+            ProcIo().bytes += (size_t)n;
+            start = 0;
+            len = (size_t)n;
+        }
+        // struct linux_dirent64: u64 d_ino, s64 d_off, u16 d_reclen, u8 d_type, char d_name[].
+        unsigned short reclen;
+        memcpy(&reclen, buf.data() + start + 16, sizeof(reclen));
+        name = buf.data() + start + 19;
+        start += reclen;
+        return true;
+    }
+};
+
+// Forward-only cursor over a text buffer with hand-rolled integer parsing.
+// Nothing here allocates or depends on locale.
+class TextScanner {
+private:
+    const char* p;
+    const char* end;
+
+public:
+    TextScanner(const char* data, size_t size) : p(data), end(data + size) {}
+    explicit TextScanner(const ProcFile& f) : p(f.Data()), end(f.Data() + f.Size()) {}
+
+    bool AtEnd() const { return p >= end; }
+    const char* Pos() const { return p; }
+    const char* End() const { return end; }
+    char Peek() const { return p < end ? *p : '\0'; }
+
+    void SkipBlanks() {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+    }
+
+    void SkipLine() {
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+        p = nl ? nl + 1 : end;
+    }
+
+    bool Skip(char c) {
+        if (p < end && *p == c) { p++; return true; }
+        return false;
+    }
+
+    void SkipTo(char c) {
+        const char* q = (const char*)memchr(p, c, (size_t)(end - p));
+        p = q ? q : end;
+    }
+
+    bool StartsWith(const char* lit, size_t n) const {
+        return (size_t)(end - p) >= n && memcmp(p, lit, n) == 0;
+    }
+
+    bool Consume(const char* lit, size_t n) {
+        if (!StartsWith(lit, n)) return false;
+        p += n;
+        return true;
+    }
+
+    // Next whitespace-delimited token; returns its length (0 at end of line).
+    size_t Word(const char*& word) {
+        SkipBlanks();
+        word = p;
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\n') p++;
+        return (size_t)(p - word);
+    }
+
+    bool U64(uint64_t& v) {
+        SkipBlanks();
+        if (p >= end || (unsigned)(*p - '0') > 9) return false;
+        uint64_t r = 0;
+        while (p < end && (unsigned)(*p - '0') <= 9) r = r * 10 + (uint64_t)(*p++ - '0');
+        v = r;
+        return true;
+    }
+
+    uint64_t U64() {
+        uint64_t v = 0;
+        U64(v);
+        return v;
+    }
+
+    int64_t I64() {
+        SkipBlanks();
+        bool neg = Skip('-');
+        uint64_t v = U64();
+        return neg ? -(int64_t)v : (int64_t)v;
+    }
+
+    // Fixed-point decimal such as "12.34" (no exponent), as found in loadavg and PSI.
+    double Decimal() {
+        SkipBlanks();
+        bool neg = Skip('-');
+        double v = (double)U64();
+        if (Skip('.')) {
+            double scale = 0.1;
+            while (p < end && (unsigned)(*p - '0') <= 9) {
+                v += (double)(*p++ - '0') * scale;
+                scale *= 0.1;
+            }
+        }
+        return neg ? -v : v;
+    }
+
+    uint64_t Hex() {
+        SkipBlanks();
+        uint64_t r = 0;
+        while (p < end) {
+            unsigned c = (unsigned char)*p;
+            unsigned d = c - '0';
+            if (d > 9) {
+                d = (c | 0x20) - 'a';
+                if (d > 5) break;
+                d += 10;
+            }
+            r = (r << 4) | d;
+            p++;
+        }
+        return r;
+    }
+};
+
+// A batch of single-integer sysfs files (temperatures, frequencies, counters) kept
+// open side by side. They share one small scratch buffer and land in a flat value
+// array indexed in Add() order, so hundreds of them cost one pread each and no
+// per-file allocation.
+class SysValueSet {
+private:
+    std::vector<int> fds;
+    std::vector<int64_t> values;
+    std::vector<uint8_t> valid;
+
+public:
+    SysValueSet() {}
+    SysValueSet(const SysValueSet&) = delete;
+    SysValueSet& operator=(const SysValueSet&) = delete;
+    ~SysValueSet() { Clear(); }
+
+    // Returns the slot index, or -1 if the file cannot be opened.
+    int Add(const char* path) {
+        int fd = SysRoot().empty() ? open(path, O_RDONLY | O_CLOEXEC) : open(SysPath(path).c_str(), O_RDONLY | O_CLOEXEC);
+        ProcIo().syscalls++;
+        ProcIo().opens++;
+        if (fd < 0) return -1;
+        PinnedFds().Opened();
+        fds.push_back(fd);
+        values.push_back(0);
+        valid.push_back(0);
+        return (int)fds.size() - 1;
+    }
+
+    void Clear() {
+        for (int fd : fds) {
+            close(fd);
+            PinnedFds().Closed();
+        }
+        fds.clear();
+        values.clear();
+        valid.clear();
+    }
+
+    size_t Size() const { return fds.size(); }
+
+    bool Read(size_t i) {
+        char buf[32];
+        ssize_t n;
+        do {
+            n = pread(fds[i], buf, sizeof(buf), 0);
+            ProcIo().syscalls++;
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) { valid[i] = 0; return false; }
+        ProcIo().bytes += (uint64_t)n;
+
+        const char* p = buf;
+        const char* end = buf + n;
+        bool neg = p < end && *p == '-';
+        if (neg) p++;
+        if (p >= end || (unsigned)(*p - '0') > 9) { valid[i] = 0; return false; }
+        int64_t v = 0;
+        while (p < end && (unsigned)(*p - '0') <= 9) v = v * 10 + (*p++ - '0');
+        values[i] = neg ? -v : v;
+        valid[i] = 1;
+        return true;
+    }
+
+    void ReadAll() {
+        for (size_t i = 0; i < fds.size(); i++) Read(i);
+    }
+
+    int64_t Value(size_t i) const { return values[i]; }
+    bool Valid(size_t i) const { return valid[i] != 0; }
+    const int64_t* Values() const { return values.data(); }
+};
+
+// Parses a sysfs cpulist such as "0-3,8,10-11" into CPU indices.
+inline void ParseCpuList(const char* data, size_t size, std::vector<int>& out) {
+    out.clear();
+    TextScanner s(data, size);
+    uint64_t first = 0;
+    while (s.U64(first)) {
+        uint64_t last = first;
+        if (s.Skip('-')) s.U64(last);
+        for (uint64_t c = first; c <= last; c++) out.push_back((int)c);
+        if (!s.Skip(',')) break;
+    }
+}
+
+// Init-time convenience: opens, reads and closes a single-value file.
+inline bool ReadFileU64(const char* path, uint64_t& value) {
+    ProcFile f;
+    if (!f.Open(path, 64) || !f.Read()) return false;
+    TextScanner s(f);
+    return s.U64(value);
+}
+
+// Identifies the physical core `cpu` belongs to by its SMT siblings: the first CPU
+// of topology/core_cpus_list (thread_siblings_list before Linux 5.6). core_id is not
+// unique within a package on multi-die parts and some arm64 layouts, so it is only
+// the fallback, tagged with bit 63 to stay clear of CPU numbers.
+inline uint64_t PhysicalCoreKey(int cpu) {
+    static const char* const LISTS[] = { "core_cpus_list", "thread_siblings_list" };
+    char path[128];
+    std::vector<int> siblings;
+    for (const char* list : LISTS) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, list);
+        ProcFile f;
+        if (!f.Open(path, 4096) || !f.Read()) continue;
+        ParseCpuList(f.Data(), f.Size(), siblings);
+        if (!siblings.empty()) return (uint64_t)siblings.front();
+    }
+    uint64_t pkg = 0, core = 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    ReadFileU64(path, pkg);
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+    ReadFileU64(path, core);
+    return (1ull << 63) | (pkg << 32) | core;
+}
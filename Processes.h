@@ -0,0 +1,203 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <unistd.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+#include "SlotMap.h"
+
+// top-style per-process CPU, RSS, threads, faults and state from /proc/<pid>/stat.
+// Processes live in a SlotMap keyed by pid, so a record (and the open stat fd and
+// buffer inside it) stays put for the life of the process and is reused by the
+// next one. Each tick the /proc listing is re-read with getdents64 and stamped with
+// a generation: listed pids without a record are opened, records the listing did
+// not stamp have exited. Steady state is one pread per process and no allocation.
+// Pinned stat fds come out of the shared PinnedFds() budget, at most half of what
+// the other providers' fds leave free; past that, further processes fall back to
+// open, read and close on every tick, and pinned ones are given back if the other
+// fds grow into the share.
+class ProcessProvider : public SensorProvider {
+private:
+    static constexpr float FD_SHARE = 0.5f;
+
+    // Fields of /proc/<pid>/stat after "pid (comm) state", numbered as in proc(5).
+    enum Field {
+        F_PPID = 4, F_MINFLT = 10, F_MAJFLT = 12, F_UTIME = 14, F_STIME = 15,
+        F_NUM_THREADS = 20, F_STARTTIME = 22, F_RSS = 24, F_LAST = F_RSS
+    };
+
+    enum Counter { C_CPU_TICKS, C_MINFLT, C_MAJFLT, C_COUNTER_COUNT };
+
+    struct Process {
+        int pid = 0;
+        uint32_t gen = 0;
+        uint64_t start = ~0ull;
+        bool pinned = false;
+        ProcFile stat;
+        ProcessStats stats;
+    };
+
+    ProcDir proc;
+    SlotMap index;
+    std::vector<Process> procs;
+    RateStage rates;
+    uint32_t gen = 0;
+    size_t pinnedFds = 0;
+    float ticksToPercent = 1.0f;
+    float pageMb = 4096.0f / (1024.0f * 1024.0f);
+
+    static int ParsePid(const char* name) {
+        int pid = 0;
+        for (; *name; name++) {
+            if ((unsigned)(*name - '0') > 9) return 0;
+            pid = pid * 10 + (*name - '0');
+        }
+        return pid;
+    }
+
+    int Discover(int pid) {
+        int slot = index.Insert((uint64_t)pid);
+        if ((size_t)slot >= procs.size()) {
+            procs.resize(index.Capacity());
+            rates.Resize(index.Capacity() * C_COUNTER_COUNT);
+        }
+        for (int k = 0; k < C_COUNTER_COUNT; k++) rates.Reset((size_t)slot * C_COUNTER_COUNT + k);
+
+        // Reset field by field: the ProcFile keeps its buffer for the next tenant.
+        Process& p = procs[slot];
+        p.pid = pid;
+        p.start = ~0ull;
+        p.stats = ProcessStats();
+        p.stats.pid = pid;
+        p.pinned = PinnedFds().Acquire(pinnedFds, 1, FD_SHARE);
+        if (p.pinned && !OpenStat(p)) {
+            PinnedFds().Release(pinnedFds, 1);
+            p.pinned = false;
+        }
+        return slot;
+    }
+
+    static bool OpenStat(Process& p) {
+        char path[32];
+        snprintf(path, sizeof(path), "/proc/%d/stat", p.pid);
+        return p.stat.Open(path, 1024);
+    }
+
+    void Unpin(Process& p) {
+        if (p.pinned) PinnedFds().Release(pinnedFds, 1);
+        p.pinned = false;
+        p.stat.Close();
+    }
+
+    void Drop(int slot) {
+        Unpin(procs[slot]);
+        index.Erase(slot);
+    }
+
+    bool Update(int slot) {
+        Process& p = procs[slot];
+        if (p.pinned && PinnedFds().Over(pinnedFds, FD_SHARE)) Unpin(p);
+        if (p.pinned) return p.stat.Read() && Parse(slot);
+        bool ok = OpenStat(p) && p.stat.Read() && Parse(slot);
+        p.stat.Close();
+        return ok;
+    }
+
+    // "1234 (comm with spaces) S 1 1234 ..." ; comm may hold ')' so split at the last one.
+    bool Parse(int slot) {
+        Process& p = procs[slot];
+        const char* data = p.stat.Data();
+        size_t size = p.stat.Size();
+        const char* open = (const char*)memchr(data, '(', size);
+        const char* close = (const char*)memrchr(data, ')', size);
+        if (!open || !close || close < open) return false;
+
+        TextScanner s(close + 1, (size_t)(data + size - close - 1));
+        s.SkipBlanks();
+        char state = s.Peek();
+        s.Skip(state);
+        int64_t f[F_LAST + 1] = { 0 };
+        for (int i = F_PPID; i <= F_LAST; i++) f[i] = s.I64();
+
+        // A recycled pid whose record was never dropped is a different process.
+        uint64_t start = (uint64_t)f[F_STARTTIME];
+        if (p.start != start) {
+            for (int k = 0; k < C_COUNTER_COUNT; k++) rates.Reset((size_t)slot * C_COUNTER_COUNT + k);
+            size_t len = std::min((size_t)(close - open - 1), sizeof(p.stats.name) - 1);
+            memset(p.stats.name, 0, sizeof(p.stats.name));
+            memcpy(p.stats.name, open + 1, len);
+            p.start = start;
+        }
+
+        ProcessStats& st = p.stats;
+        size_t base = (size_t)slot * C_COUNTER_COUNT;
+        st.state = state;
+        st.cpu_percent = rates.Rate(base + C_CPU_TICKS, (uint64_t)(f[F_UTIME] + f[F_STIME])) * ticksToPercent;
+        st.minflt_per_s = rates.Rate(base + C_MINFLT, (uint64_t)f[F_MINFLT]);
+        st.majflt_per_s = rates.Rate(base + C_MAJFLT, (uint64_t)f[F_MAJFLT]);
+        st.rss_mb = (float)f[F_RSS] * pageMb;
+        st.threads = (unsigned)f[F_NUM_THREADS];
+        return true;
+    }
+
+public:
+    const char* Name() const override { return "processes"; }
+
+    bool Init() override {
+        long hz = sysconf(_SC_CLK_TCK);
+        long page = sysconf(_SC_PAGESIZE);
+        if (hz > 0) ticksToPercent = 100.0f / (float)hz;
+        if (page > 0) pageMb = (float)page / (1024.0f * 1024.0f);
+        PinnedFds();
+        return proc.Open("/proc");
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        if (!proc.Rewind()) return;
+        gen++;
+        const char* name;
+        while (proc.Next(name)) {
+            int pid = ParsePid(name);
+            if (pid <= 0) continue;
+            int slot = index.Find((uint64_t)pid);
+            if (slot < 0) slot = Discover(pid);
+            procs[slot].gen = gen;
+        }
+
+        rates.Begin();
+        ProcessTable& out = snap.processes;
+        out.count = out.threads = out.running = out.uninterruptible = out.zombies = 0;
+        TopN<PROCESS_TOP> top;
+        for (size_t n = 0; n < procs.size(); n++) {
+            if (!index.Used((int)n)) continue;
+            if (procs[n].gen != gen || !Update((int)n)) {
+                Drop((int)n);
+                continue;
+            }
+            const ProcessStats& st = procs[n].stats;
+            out.count++;
+            out.threads += (int)st.threads;
+            if (st.state == 'R') out.running++;
+            else if (st.state == 'D') out.uninterruptible++;
+            else if (st.state == 'Z') out.zombies++;
+            top.Offer(st.cpu_percent, (int)n);
+        }
+
+        out.top.resize(top.Count());
+        for (int k = 0; k < top.Count(); k++) out.top[k] = procs[top[k]].stats;
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "proc_count", "" });
+        out.push_back({ "proc_threads", "" });
+        out.push_back({ "proc_cpu", "%" });
+        out.push_back({ "proc_rss", "MB" });
+        out.push_back({ "proc_minflt", "1/s" });
+        out.push_back({ "proc_majflt", "1/s" });
+    }
+};
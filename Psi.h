@@ -0,0 +1,124 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+
+// Pressure stall information from /proc/pressure/{cpu,memory,io}. Besides the
+// per-tick read, each resource gets a kernel PSI trigger whose fd the sampler
+// polls, so a stall wakes it immediately instead of at the next period.
+class PsiProvider : public SensorProvider {
+private:
+    enum Resource { PSI_CPU, PSI_MEMORY, PSI_IO, PSI_RESOURCE_COUNT };
+
+    struct TriggerSpec {
+        const char* path;
+        const char* kind;
+        unsigned stallUs;
+    };
+
+    // Stall budget per 1 s window before the sampler is woken.
+    static constexpr TriggerSpec TRIGGERS[PSI_RESOURCE_COUNT] = {
+        { "/proc/pressure/cpu", "some", 250000 },
+        { "/proc/pressure/memory", "some", 100000 },
+        { "/proc/pressure/io", "some", 200000 },
+    };
+
+    ProcFile files[PSI_RESOURCE_COUNT];
+    int triggers[PSI_RESOURCE_COUNT] = { -1, -1, -1 };
+    RateStage rates;
+
+    // Unprivileged triggers need a window that is a multiple of 2 s (Linux 6.5+), so
+    // a rejected 1 s window is retried at 2 s with the budget scaled to match.
+    static int OpenTrigger(const TriggerSpec& spec) {
+        int fd = open(spec.path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        ProcIo().syscalls++;
+        if (fd < 0) return -1;
+
+        char buf[64];
+        for (unsigned windowUs = 1000000; windowUs <= 2000000; windowUs *= 2) {
+            int n = snprintf(buf, sizeof(buf), "%s %u %u", spec.kind, spec.stallUs * (windowUs / 1000000), windowUs);
+            if (write(fd, buf, (size_t)n + 1) > 0) return fd;
+        }
+        close(fd);
+        return -1;
+    }
+
+    // "some avg10=0.12 avg60=0.05 avg300=0.01 total=123456"
+    static void ParseLine(TextScanner& s, float& avg10, float& avg60, uint64_t& total) {
+        s.SkipTo('=');
+        s.Skip('=');
+        avg10 = (float)s.Decimal();
+        s.SkipTo('=');
+        s.Skip('=');
+        avg60 = (float)s.Decimal();
+        s.SkipTo('=');
+        s.Skip('=');
+        s.Decimal();
+        s.SkipTo('=');
+        s.Skip('=');
+        total = s.U64();
+        s.SkipLine();
+    }
+
+    void SampleResource(int r, PsiResource& out) {
+        if (!files[r].Read()) return;
+        TextScanner s(files[r]);
+        while (!s.AtEnd()) {
+            if (s.Consume("some", 4)) ParseLine(s, out.some_avg10, out.some_avg60, out.some_total_us);
+            else if (s.Consume("full", 4)) ParseLine(s, out.full_avg10, out.full_avg60, out.full_total_us);
+            else s.SkipLine();
+        }
+        // Stalled microseconds per second / 1e4 = percent of the interval.
+        out.some_now = std::min(100.0f, rates.Rate((size_t)r * 2, out.some_total_us) / 10000.0f);
+        out.full_now = std::min(100.0f, rates.Rate((size_t)r * 2 + 1, out.full_total_us) / 10000.0f);
+    }
+
+public:
+    ~PsiProvider() {
+        for (int fd : triggers) if (fd >= 0) close(fd);
+    }
+
+    const char* Name() const override { return "psi"; }
+
+    bool Init() override {
+        bool any = false;
+        for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+            if (!files[r].Open(TRIGGERS[r].path, 256)) continue;
+            any = true;
+            // Triggers only make sense against the live kernel, never a replayed tree.
+            if (SysRoot().empty()) triggers[r] = OpenTrigger(TRIGGERS[r]);
+        }
+        rates.Resize(PSI_RESOURCE_COUNT * 2);
+        return any;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        rates.Begin();
+        snap.psi.available = true;
+        SampleResource(PSI_CPU, snap.psi.cpu);
+        SampleResource(PSI_MEMORY, snap.psi.memory);
+        SampleResource(PSI_IO, snap.psi.io);
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "psi_cpu_some_avg10", "%" });
+        out.push_back({ "psi_cpu_some_avg60", "%" });
+        out.push_back({ "psi_memory_some_avg10", "%" });
+        out.push_back({ "psi_memory_full_avg10", "%" });
+        out.push_back({ "psi_io_some_avg10", "%" });
+        out.push_back({ "psi_io_full_avg10", "%" });
+        out.push_back({ "psi_stall_now", "%" });
+        out.push_back({ "psi_total", "us" });
+    }
+
+    void WakeFds(std::vector<int>& out) const override {
+        for (int fd : triggers) if (fd >= 0) out.push_back(fd);
+    }
+};
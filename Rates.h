@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+
+// Converts monotonically increasing kernel counters into per-second rates. Every
+// provider that reports "events per second" feeds its raw counters through one of
+// these: Begin() once per tick, then Rate() per slot. The first sample of a slot,
+// and any counter that went backwards (reset, device replaced), yields 0.
+class RateStage {
+private:
+    std::vector<uint64_t> prev;
+    std::vector<uint8_t> seen;
+    uint64_t lastNs = 0;
+    double perSecond = 0.0;
+
+public:
+    void Resize(size_t n) {
+        if (n <= prev.size()) return;
+        prev.resize(n, 0);
+        seen.resize(n, 0);
+    }
+
+    size_t Size() const { return prev.size(); }
+
+    // Forgets one slot's history, e.g. when the device behind it is removed.
+    void Reset(size_t i) { seen[i] = 0; }
+
+    void Begin() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t now = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+        perSecond = (lastNs && now > lastNs) ? 1e9 / (double)(now - lastNs) : 0.0;
+        lastNs = now;
+    }
+
+    // Seconds covered by the current interval (0 on the first tick).
+    double Interval() const { return perSecond > 0.0 ? 1.0 / perSecond : 0.0; }
+
+    float Rate(size_t i, uint64_t value) {
+        float r = 0.0f;
+        if (seen[i] && value >= prev[i]) r = (float)((double)(value - prev[i]) * perSecond);
+        prev[i] = value;
+        seen[i] = 1;
+        return r;
+    }
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+
+// "0.52 0.58 0.59 2/1203 48211": three load averages, runnable/total tasks, last pid.
+// procs_running from /proc/stat is the same count as the runnable field, so only the
+// total is kept from here.
+inline bool ParseLoadavg(const char* data, size_t size, SchedStats& out) {
+    TextScanner s(data, size);
+    out.load1 = (float)s.Decimal();
+    out.load5 = (float)s.Decimal();
+    out.load15 = (float)s.Decimal();
+    uint64_t runnable = 0, total = 0;
+    if (!s.U64(runnable) || !s.Skip('/') || !s.U64(total)) return false;
+    out.tasks_total = (unsigned)total;
+    return true;
+}
+
+// Per-core run-queue delay from /proc/schedstat (Documentation/scheduler/sched-stats.rst).
+// Each "cpuN" line ends with time spent running and time spent waiting to run (ns),
+// then the number of timeslices run; wait over timeslices is the mean scheduling
+// latency. Both are fed through rates so the ratio covers the last interval only.
+// The "domainN" lines under each CPU are skipped.
+class SchedStatReader {
+private:
+    // Fields after "cpuN" (version 15 and later).
+    enum Field { F_YLD, F_SCHED_SWITCH, F_SCHED_COUNT, F_SCHED_GOIDLE, F_TTWU, F_TTWU_LOCAL, F_RUN_NS, F_WAIT_NS, F_SLICES, F_FIELD_COUNT };
+
+    ProcFile file;
+    RateStage rates;
+
+public:
+    bool Init() {
+        return file.Open("/proc/schedstat", 65536);
+    }
+
+    void Sample(SchedStats& out) {
+        if (!file.Read()) return;
+        rates.Begin();
+
+        double sum = 0.0;
+        int counted = 0;
+        out.latency_ms_max = 0.0f;
+        out.latency_worst_core = -1;
+
+        TextScanner s(file);
+        while (!s.AtEnd()) {
+            if (!s.Consume("cpu", 3)) { s.SkipLine(); continue; }
+            size_t cpu = (size_t)s.U64();
+            uint64_t f[F_FIELD_COUNT] = { 0 };
+            for (int i = 0; i < F_FIELD_COUNT; i++) s.U64(f[i]);
+            s.SkipLine();
+
+            if (cpu >= out.latency_ms.size()) {
+                out.latency_ms.resize(cpu + 1, 0.0f);
+                rates.Resize((cpu + 1) * 2);
+            }
+            float wait = rates.Rate(cpu * 2, f[F_WAIT_NS]);
+            float slices = rates.Rate(cpu * 2 + 1, f[F_SLICES]);
+            float ms = slices > 0.0f ? wait / slices / 1e6f : 0.0f;
+            out.latency_ms[cpu] = ms;
+            sum += ms;
+            counted++;
+            if (ms > out.latency_ms_max) {
+                out.latency_ms_max = ms;
+                out.latency_worst_core = (int)cpu;
+            }
+        }
+        out.latency_ms_mean = counted ? (float)(sum / counted) : 0.0f;
+        out.schedstat = counted > 0;
+    }
+};
@@ -0,0 +1,475 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "CpuCores.h"
+
+enum GpuSource { SOURCE_NONE, SOURCE_NVIDIA, SOURCE_AMD, SOURCE_INTEL, SOURCE_PDH };
+
+enum TempKind { TEMP_CPU_PACKAGE, TEMP_CPU_CORE, TEMP_GPU, TEMP_NVME, TEMP_BOARD, TEMP_OTHER };
+
+enum WakeReason { WAKE_PERIOD, WAKE_EVENT, WAKE_STOP };
+
+struct MetricDesc {
+    const char* name;
+    const char* unit;
+};
+
+struct GpuDeviceStats {
+    int index = 0;
+    char name[96] = { 0 };
+    float load = 0.0f;
+    float mem_load = 0.0f;
+    float temp = 0.0f;
+    float vram_used_gb = 0.0f;
+    float vram_total_gb = 0.0f;
+
+    float power_w = 0.0f;
+    float sm_clock_mhz = 0.0f;
+    float mem_clock_mhz = 0.0f;
+    float req_clock_mhz = 0.0f;
+    float pcie_tx_mbps = 0.0f;
+    float pcie_rx_mbps = 0.0f;
+    float fan_percent = 0.0f;
+    unsigned long long throttle_reasons = 0;
+    bool throttled = false;
+};
+
+struct TempSensor {
+    char label[48] = { 0 };
+    TempKind kind = TEMP_OTHER;
+    float celsius = 0.0f;
+};
+
+// Memory detail beyond used/total. Linux fills all of it from /proc/meminfo; the
+// Win32 backend only fills used_no_cache_* (its "available" already counts standby).
+struct MemBreakdown {
+    float cached_gb = 0.0f;
+    float buffers_gb = 0.0f;
+    float dirty_mb = 0.0f;
+    float writeback_mb = 0.0f;
+    float slab_gb = 0.0f;
+    float slab_reclaimable_gb = 0.0f;
+    float shmem_gb = 0.0f;
+    float anon_huge_gb = 0.0f;
+    float swap_total_gb = 0.0f;
+    float swap_used_gb = 0.0f;
+    unsigned hugepages_total = 0;
+    unsigned hugepages_free = 0;
+    float hugepage_size_mb = 0.0f;
+    float hugetlb_gb = 0.0f;
+
+    float used_no_cache_gb = 0.0f;
+    float used_no_cache_percent = 0.0f;
+};
+
+// Paging and reclaim activity in events (pages) per second, plus zram totals.
+struct VmRates {
+    float pgfault = 0.0f;
+    float pgmajfault = 0.0f;
+    float pswpin = 0.0f;
+    float pswpout = 0.0f;
+    float zswpin = 0.0f;
+    float zswpout = 0.0f;
+    float pgscan_kswapd = 0.0f;
+    float pgscan_direct = 0.0f;
+    float pgscan_khugepaged = 0.0f;
+    float pgsteal_kswapd = 0.0f;
+    float pgsteal_direct = 0.0f;
+    float pgsteal_khugepaged = 0.0f;
+    float compact_stall = 0.0f;
+    float thp_fault_fallback = 0.0f;
+
+    int zram_devices = 0;
+    float zram_orig_mb = 0.0f;
+    float zram_compr_mb = 0.0f;
+    float zram_used_mb = 0.0f;
+    float zram_ratio = 0.0f;
+};
+
+// Pressure stall information for one resource: the kernel's running averages (in %
+// of time stalled) and the cumulative stall time, plus the share of the last
+// sampling interval spent stalled, derived from the totals.
+struct PsiResource {
+    float some_avg10 = 0.0f;
+    float some_avg60 = 0.0f;
+    float full_avg10 = 0.0f;
+    float full_avg60 = 0.0f;
+    uint64_t some_total_us = 0;
+    uint64_t full_total_us = 0;
+    float some_now = 0.0f;
+    float full_now = 0.0f;
+};
+
+struct PsiStats {
+    bool available = false;
+    PsiResource cpu;
+    PsiResource memory;
+    PsiResource io;
+};
+
+// Usage against the sampler's own cgroup v2 quota. cpu_quota_cores / memory_limit_gb
+// fall back to the host's size when the cgroup has no limit; host_* keep the
+// figures the headline fields held before a quota replaced them.
+struct CgroupStats {
+    bool available = false;
+    char path[96] = { 0 };
+
+    bool cpu_limited = false;
+    float cpu_quota_cores = 0.0f;
+    float cpu_used_cores = 0.0f;
+    float cpu_percent = 0.0f;
+    float throttled_percent = 0.0f;
+    float throttled_ms_per_s = 0.0f;
+    uint64_t nr_throttled = 0;
+
+    bool memory_limited = false;
+    float memory_limit_gb = 0.0f;
+    float memory_used_gb = 0.0f;
+    float memory_percent = 0.0f;
+
+    float host_cpu_load = 0.0f;
+    float host_ram_total_gb = 0.0f;
+};
+
+// One block device from /proc/diskstats; rates are per second over the last tick.
+struct DiskDeviceStats {
+    char name[32] = { 0 };
+    bool partition = false;
+    bool is_virtual = false;
+    float read_mbps = 0.0f;
+    float write_mbps = 0.0f;
+    float read_iops = 0.0f;
+    float write_iops = 0.0f;
+    float read_await_ms = 0.0f;
+    float write_await_ms = 0.0f;
+    float await_ms = 0.0f;
+    unsigned in_flight = 0;
+    float queue_depth = 0.0f;
+    float util = 0.0f;
+};
+
+// Totals over whole physical disks only, so partitions and dm/md stacks on top of
+// them are not counted twice.
+struct DiskAggregate {
+    int count = 0;
+    float read_mbps = 0.0f;
+    float write_mbps = 0.0f;
+    float read_iops = 0.0f;
+    float write_iops = 0.0f;
+    float util_max = 0.0f;
+    int busiest = -1;
+};
+
+// One network interface from /proc/net/dev; throughput in Mbit/s so it compares
+// directly with the sysfs link speed, everything else per second.
+struct NetInterfaceStats {
+    char name[16] = { 0 };
+    bool is_virtual = false;
+    float speed_mbit = 0.0f;
+    float rx_mbit = 0.0f;
+    float tx_mbit = 0.0f;
+    float rx_packets = 0.0f;
+    float tx_packets = 0.0f;
+    float rx_drops = 0.0f;
+    float tx_drops = 0.0f;
+    float rx_errors = 0.0f;
+    float tx_errors = 0.0f;
+    // Busier direction as % of line rate; 0 when the driver reports no speed.
+    float link_percent = 0.0f;
+};
+
+// Totals over physical interfaces only (veth/bridge traffic is already counted there).
+struct NetAggregate {
+    int count = 0;
+    float rx_mbit = 0.0f;
+    float tx_mbit = 0.0f;
+    float drops = 0.0f;
+    float errors = 0.0f;
+    float link_percent_max = 0.0f;
+    int busiest = -1;
+};
+
+static const int SOCKET_TOP = 5;
+static const int TCP_STATE_COUNT = 12;
+
+// TCP states as numbered by the kernel (include/net/tcp_states.h); 0 is unused.
+constexpr const char* TCP_STATE_NAMES[TCP_STATE_COUNT] = {
+    "", "ESTABLISHED", "SYN_SENT", "SYN_RECV", "FIN_WAIT1", "FIN_WAIT2",
+    "TIME_WAIT", "CLOSE", "CLOSE_WAIT", "LAST_ACK", "LISTEN", "CLOSING",
+};
+
+struct SocketPeer {
+    char addr[48] = { 0 };
+    int count = 0;
+};
+
+struct SocketPort {
+    int port = 0;
+    int count = 0;
+};
+
+// Summary of the TCP/UDP socket tables (v4 + v6) and the /proc/net/snmp error
+// counters. Each table pass is spread over several ticks; these are from the last
+// finished one.
+struct SocketStats {
+    bool available = false;
+    int tcp_state[TCP_STATE_COUNT] = { 0 };
+    int tcp_total = 0;
+    int udp_total = 0;
+    float udp_rx_queue_kb = 0.0f;
+    uint64_t udp_drops = 0;
+
+    // Remote peers and local ports with the most non-listening TCP sockets.
+    SocketPeer top_peers[SOCKET_TOP];
+    int top_peer_count = 0;
+    SocketPort top_ports[SOCKET_TOP];
+    int top_port_count = 0;
+    // Only the first 8192 distinct peers are ranked; sockets to any further peer are
+    // counted here, so a non-zero value means the peer list is truncated.
+    int distinct_peers = 0;
+    unsigned untracked_peer_sockets = 0;
+
+    float retrans_per_s = 0.0f;
+    float retrans_percent = 0.0f;
+    float in_errs_per_s = 0.0f;
+    float out_rsts_per_s = 0.0f;
+    float udp_in_errors_per_s = 0.0f;
+    float udp_rcvbuf_errors_per_s = 0.0f;
+
+    // Cost of the last table pass, summed over the ticks it was spread across.
+    unsigned scan_rows = 0;
+    float scan_us = 0.0f;
+};
+
+// Scheduler health: counters from the /proc/stat pass, /proc/loadavg and, where the
+// kernel has /proc/schedstat, run-queue latency per core (indexed by CPU number).
+struct SchedStats {
+    float ctxt_per_s = 0.0f;
+    float forks_per_s = 0.0f;
+    unsigned procs_running = 0;
+    unsigned procs_blocked = 0;
+
+    float load1 = 0.0f;
+    float load5 = 0.0f;
+    float load15 = 0.0f;
+    unsigned tasks_total = 0;
+
+    // Mean time from becoming runnable to running, per timeslice.
+    bool schedstat = false;
+    std::vector<float> latency_ms;
+    float latency_ms_mean = 0.0f;
+    float latency_ms_max = 0.0f;
+    int latency_worst_core = -1;
+};
+
+static const int IRQ_TOP = 16;
+static const int SOFTIRQ_COUNT = 10;
+static const int SOFTIRQ_NET_RX = 3;
+
+// Rows of /proc/softirqs in kernel order (include/linux/interrupt.h).
+constexpr const char* SOFTIRQ_NAMES[SOFTIRQ_COUNT] = {
+    "HI", "TIMER", "NET_TX", "NET_RX", "BLOCK", "IRQ_POLL", "TASKLET", "SCHED", "HRTIMER", "RCU",
+};
+
+struct IrqRate {
+    char name[16] = { 0 };  // "24", "NMI", "LOC", "NET_RX"
+    char desc[48] = { 0 };  // chip, hwirq and handler, e.g. "PCI-MSI 524288-edge eth0-rx-0"
+    float rate = 0.0f;
+    int top_cpu = -1;
+    float top_share = 0.0f;  // % of this row's interrupts taken by top_cpu
+};
+
+// Hard and soft interrupt rates per source and per CPU. The per-CPU tables are
+// row-major with one column per CPU listed in the file's header (irq_cpus /
+// softirq_cpus), since offline CPUs leave gaps in the numbering.
+struct InterruptStats {
+    bool available = false;
+    float irq_total = 0.0f;
+    std::vector<int> irq_cpus;
+    std::vector<float> irq_cpu_rates;  // all hard interrupts, per column
+    std::vector<IrqRate> irqs;         // busiest first, at most IRQ_TOP
+    std::vector<float> irq_rates;      // irqs.size() rows
+
+    std::vector<int> softirq_cpus;
+    IrqRate softirqs[SOFTIRQ_COUNT];
+    std::vector<float> softirq_rates;  // SOFTIRQ_COUNT rows
+
+    // NET_RX concentration: the busiest core, its share of all NET_RX work, and its
+    // rate over the mean per online core (1 is perfectly even).
+    int net_rx_cpu = -1;
+    float net_rx_share = 0.0f;
+    float net_rx_imbalance = 0.0f;
+    bool net_rx_imbalanced = false;
+};
+
+// One node of the cgroup v2 tree. Leaves are read from their own files; interior
+// nodes are the sum of the live leaves below them.
+struct CgroupUsage {
+    char name[64] = { 0 };
+    int depth = 0;
+    int leaves = 0;
+    float cpu_cores = 0.0f;
+    float memory_mb = 0.0f;
+    float read_mbps = 0.0f;
+    float write_mbps = 0.0f;
+};
+
+static const int CGROUP_TOP = 3;
+
+static const int MAX_GPU_ENGINES = 8;
+
+// One process's share of the GPU, summed over its DRM clients (Linux fdinfo).
+struct GpuProcessStats {
+    int pid = 0;
+    char name[16] = { 0 };
+    float engine[MAX_GPU_ENGINES] = { 0 };
+    float busiest = 0.0f;
+    float memory_mb = 0.0f;
+};
+
+static const int PROCESS_TOP = 16;
+
+struct ProcessStats {
+    int pid = 0;
+    char name[16] = { 0 };
+    char state = ' ';
+    float cpu_percent = 0.0f;  // of one core, as top shows it
+    float rss_mb = 0.0f;
+    unsigned threads = 0;
+    float minflt_per_s = 0.0f;
+    float majflt_per_s = 0.0f;
+};
+
+// Counts over every process, and the busiest by CPU.
+struct ProcessTable {
+    int count = 0;
+    int threads = 0;
+    int running = 0;
+    int uninterruptible = 0;
+    int zombies = 0;
+    std::vector<ProcessStats> top;  // busiest first, at most PROCESS_TOP
+};
+
+struct GpuAggregate {
+    int count = 0;
+    float load_max = 0.0f;
+    float load_mean = 0.0f;
+    float temp_max = 0.0f;
+    float temp_mean = 0.0f;
+    float vram_used_sum = 0.0f;
+    float vram_total_sum = 0.0f;
+    float power_sum_w = 0.0f;
+    int throttled_count = 0;
+};
+
+// Raw (unsmoothed) values produced by one sampling pass over all providers.
+struct SensorSnapshot {
+    float cpu_load = 0.0f;
+    CpuCoreLoad cpu_cores;
+    CpuFreqStats cpu_freq;
+    CpuIdleStats cpu_idle;
+    CpuGroupLoad cpu_groups;
+    SchedStats sched;
+
+    GpuSource gpu_source = SOURCE_NONE;
+    float gpu_load = 0.0f;
+    float gpu_temp = 0.0f;
+    float gpu_vram_used = 0.0f;
+    float gpu_vram_total = 0.0f;
+    std::vector<GpuDeviceStats> gpus;
+    GpuAggregate gpu_agg;
+
+    // Sorted busiest first; engine[i] is named by gpu_engines[i].
+    std::vector<GpuProcessStats> gpu_procs;
+    char gpu_engines[MAX_GPU_ENGINES][16] = { { 0 } };
+    int gpu_engine_count = 0;
+
+    ProcessTable processes;
+
+    float ram_usage_gb = 0.0f;
+    float ram_percent = 0.0f;
+    float ram_total_gb = 0.0f;
+    MemBreakdown mem;
+    VmRates vm;
+
+    // Every discovered temperature sensor, plus the hottest reading per class.
+    std::vector<TempSensor> temps;
+    float cpu_temp = 0.0f;
+    float nvme_temp_max = 0.0f;
+    float board_temp = 0.0f;
+
+    // Filtered per-device list; disk_agg.busiest indexes into it.
+    std::vector<DiskDeviceStats> disks;
+    DiskAggregate disk_agg;
+
+    // Active interfaces except loopback; net_agg.busiest indexes into it.
+    std::vector<NetInterfaceStats> nets;
+    NetAggregate net_agg;
+    SocketStats sockets;
+    InterruptStats interrupts;
+
+    PsiStats psi;
+    CgroupStats cgroup;
+    // Preorder walk of the cgroup tree (parents before children, capped), the total
+    // number of cgroups tracked, the child cgroups left out once the tracking cap was
+    // hit (their subtrees are not counted), and the leaf cgroups using the most CPU.
+    std::vector<CgroupUsage> cgroup_tree;
+    int cgroup_count = 0;
+    int cgroup_untracked = 0;
+    CgroupUsage cgroup_top[CGROUP_TOP];
+    int cgroup_top_count = 0;
+
+    // Cost of the sampling pass that produced this snapshot.
+    float sample_us = 0.0f;
+    unsigned sample_syscalls = 0;
+    // Passes run ahead of schedule because a provider's wake fd fired (cumulative).
+    unsigned early_samples = 0;
+};
+
+// Folds the per-device list into gpu_agg and the headline gpu_* fields: load and
+// temperature follow the hottest card so one pegged GPU is never averaged away.
+inline void AggregateGpus(SensorSnapshot& snap) {
+    GpuAggregate a;
+    a.count = (int)snap.gpus.size();
+    for (const GpuDeviceStats& d : snap.gpus) {
+        a.load_max = std::max(a.load_max, d.load);
+        a.temp_max = std::max(a.temp_max, d.temp);
+        a.load_mean += d.load;
+        a.temp_mean += d.temp;
+        a.vram_used_sum += d.vram_used_gb;
+        a.vram_total_sum += d.vram_total_gb;
+        a.power_sum_w += d.power_w;
+        if (d.throttled) a.throttled_count++;
+    }
+    if (a.count > 0) {
+        a.load_mean /= (float)a.count;
+        a.temp_mean /= (float)a.count;
+    }
+    snap.gpu_agg = a;
+    snap.gpu_load = std::max(0.0f, std::min(100.0f, a.load_max));
+    snap.gpu_temp = a.temp_max;
+    snap.gpu_vram_used = a.vram_used_sum;
+    snap.gpu_vram_total = a.vram_total_sum;
+}
+
+class SensorProvider {
+public:
+    virtual ~SensorProvider() {}
+
+    virtual const char* Name() const = 0;
+
+    // Opens handles / resolves libraries. A provider returning false is dropped.
+    virtual bool Init() = 0;
+
+    // Fills the fields this provider owns; everything else is left untouched.
+    virtual void Sample(SensorSnapshot& snap) = 0;
+
+    virtual void Describe(std::vector<MetricDesc>& out) const = 0;
+
+    // Linux only: fds the sampler polls for POLLPRI alongside its timer (PSI triggers).
+    // An event re-samples just the providers that returned fds, right away.
+    virtual void WakeFds(std::vector<int>&) const {}
+};
+
+typedef std::vector<std::unique_ptr<SensorProvider>> SensorProviderList;
@@ -0,0 +1,136 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// Maps 64-bit keys (a dev_t, a name hash, a pid) to small dense slot numbers that
+// stay put for as long as the key lives, so per-slot arrays such as a RateStage
+// never move. Lookup is an open-addressing probe; slots of erased keys are reused
+// before new ones are appended. Only Insert() of a new key can allocate.
+class SlotMap {
+private:
+    std::vector<uint64_t> keys;
+    std::vector<uint8_t> used;
+    std::vector<int> freeSlots;
+    std::vector<int> table;
+    size_t live = 0;
+    int shift = 64;
+
+    size_t Home(uint64_t key) const {
+        return (size_t)((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    size_t Mask() const { return table.size() - 1; }
+
+    void Grow() {
+        size_t size = table.empty() ? 16 : table.size() * 2;
+        table.assign(size, -1);
+        shift = 64;
+        for (size_t s = size; s > 1; s >>= 1) shift--;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (!used[i]) continue;
+            size_t h = Home(keys[i]);
+            while (table[h] >= 0) h = (h + 1) & Mask();
+            table[h] = (int)i;
+        }
+    }
+
+public:
+    size_t Size() const { return live; }
+
+    // One past the highest slot ever handed out; size per-slot arrays to this.
+    size_t Capacity() const { return keys.size(); }
+
+    bool Used(int slot) const { return used[slot] != 0; }
+    uint64_t Key(int slot) const { return keys[slot]; }
+
+    int Find(uint64_t key) const {
+        if (table.empty()) return -1;
+        for (size_t h = Home(key);; h = (h + 1) & Mask()) {
+            int s = table[h];
+            if (s < 0) return -1;
+            if (keys[s] == key) return s;
+        }
+    }
+
+    // Returns the slot for `key`, allocating one if it is new.
+    int Insert(uint64_t key) {
+        int s = Find(key);
+        if (s >= 0) return s;
+        if ((live + 1) * 2 > table.size()) Grow();
+
+        if (!freeSlots.empty()) {
+            s = freeSlots.back();
+            freeSlots.pop_back();
+            keys[s] = key;
+            used[s] = 1;
+        }
+        else {
+            s = (int)keys.size();
+            keys.push_back(key);
+            used.push_back(1);
+        }
+        size_t h = Home(key);
+        while (table[h] >= 0) h = (h + 1) & Mask();
+        table[h] = s;
+        live++;
+        return s;
+    }
+
+    // Backward-shift deletion keeps every remaining key reachable without tombstones.
+    void Erase(int slot) {
+        size_t i = Home(keys[slot]);
+        while (table[i] != slot) i = (i + 1) & Mask();
+        table[i] = -1;
+        for (size_t j = (i + 1) & Mask(); table[j] >= 0; j = (j + 1) & Mask()) {
+            size_t k = Home(keys[table[j]]);
+            bool movable = i <= j ? (k <= i || k > j) : (k <= i && k > j);
+            if (movable) {
+                table[i] = table[j];
+                table[j] = -1;
+                i = j;
+            }
+        }
+        used[slot] = 0;
+        freeSlots.push_back(slot);
+        live--;
+    }
+};
+
+// FNV-1a over a name, for maps keyed by interface or IRQ names.
+inline uint64_t HashName(const char* name, size_t len) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < len; i++) h = (h ^ (unsigned char)name[i]) * 1099511628211ull;
+    return h;
+}
+
+// The N ids (slots, indices, ports) with the largest keys seen since Clear(),
+// largest first. N is a handful, so each Offer() is an insertion step into a
+// fixed array rather than a heap; equal keys keep their arrival order.
+template <int N>
+class TopN {
+private:
+    float keys[N];
+    int ids[N];
+    int count = 0;
+
+public:
+    void Clear() { count = 0; }
+    int Count() const { return count; }
+    int operator[](int k) const { return ids[k]; }
+
+    void Offer(float key, int id) {
+        int slot = count;
+        while (slot > 0 && keys[slot - 1] < key) slot--;
+        if (slot >= N) return;
+        int last = std::min(count, N - 1);
+        for (int k = last; k > slot; k--) {
+            keys[k] = keys[k - 1];
+            ids[k] = ids[k - 1];
+        }
+        keys[slot] = key;
+        ids[slot] = id;
+        count = last + 1;
+    }
+};
@@ -0,0 +1,364 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <arpa/inet.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+#include "SlotMap.h"
+
+// '0'-'9' -> 0-9 and 'A'-'F' / 'a'-'f' -> 10-15 (bit 6 marks a letter).
+inline uint32_t HexNibble(char c) {
+    return (uint32_t)(c & 0xF) + 9 * (uint32_t)((c >> 6) & 1);
+}
+
+// Eight hex digits to a 32-bit value without a per-digit loop: the ASCII bytes are
+// turned into nibbles in one 64-bit word and then folded pairwise. Little-endian
+// hosts only; elsewhere it falls back to the scanner.
+inline uint32_t Hex8(const char* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    memcpy(&v, p, 8);
+    // HexNibble() on all eight bytes at once.
+    v = (v & 0x0F0F0F0F0F0F0F0Full) + 9 * ((v >> 6) & 0x0101010101010101ull);
+    v = ((v << 4) | (v >> 8)) & 0x00FF00FF00FF00FFull;
+    v = ((v & 0x000000FF000000FFull) << 8) | ((v >> 16) & 0x000000FF000000FFull);
+    return (uint32_t)(((v & 0xFFFF) << 16) | ((v >> 32) & 0xFFFF));
+#else
+    return (uint32_t)TextScanner(p, 8).Hex();
+#endif
+}
+
+inline uint32_t Hex4(const char* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t v;
+    memcpy(&v, p, 4);
+    v = (v & 0x0F0F0F0Fu) + 9 * ((v >> 6) & 0x01010101u);
+    v = ((v << 4) | (v >> 8)) & 0x00FF00FFu;
+    return ((v & 0xFF) << 8) | (v >> 16);
+#else
+    return (uint32_t)TextScanner(p, 4).Hex();
+#endif
+}
+
+// Connection counts per TCP state, top remote peers and local ports, and UDP queue
+// and drop totals from /proc/net/{tcp,tcp6,udp,udp6}, plus retransmit and error
+// rates from /proc/net/snmp. The tables are streamed in fixed chunks and folded
+// row by row into fixed-size counters, so a 200k-socket table is never held in
+// memory. Rows are fixed-width, so fields are decoded at known offsets. A pass is
+// spread over TABLE_PERIOD ticks, each parsing its share of the bytes the previous
+// pass read, and the last finished pass is what gets published.
+class SocketTableProvider : public SensorProvider {
+private:
+    static const int TABLE_PERIOD = 5;
+    static const int PEER_BITS = 14;
+    static const size_t PEER_SLOTS = (size_t)1 << PEER_BITS;
+    static const size_t PEER_LIMIT = PEER_SLOTS / 2;
+    static const int FILTER_BITS = 16;
+    static const int TCP_LISTEN = 10;
+
+    enum Table { T_TCP, T_TCP6, T_UDP, T_UDP6, T_TABLE_COUNT };
+    enum Counter { C_OUT_SEGS, C_RETRANS, C_IN_ERRS, C_OUT_RSTS, C_UDP_IN_ERRORS, C_UDP_RCVBUF, C_COUNTER_COUNT };
+
+    static constexpr const char* TABLE_PATHS[T_TABLE_COUNT] = {
+        "/proc/net/tcp", "/proc/net/tcp6", "/proc/net/udp", "/proc/net/udp6",
+    };
+
+    // The probe table holds only what a lookup touches; addresses sit in a parallel
+    // array written once per new peer.
+    struct Peer {
+        uint64_t key;
+        uint32_t count;
+        uint32_t gen;
+    };
+
+    struct PeerAddr {
+        uint32_t words[4];
+        bool v6;
+    };
+
+    ProcStream tables[T_TABLE_COUNT];
+    ProcFile snmp;
+    RateStage rates;
+    int scanTable = 0;
+    bool scanHeader = true;
+    size_t scanBytes = 0;
+    size_t lastScanBytes = 0;
+    float scanUs = 0.0f;
+    SocketStats last;
+
+    // Per-scan counters; entries from older scans are recognised by their generation.
+    std::vector<Peer> peers;
+    std::vector<PeerAddr> peerAddrs;
+    std::vector<uint64_t> peerFilter;
+    std::vector<uint32_t> portCount;
+    std::vector<uint32_t> portGen;
+    std::vector<uint16_t> touchedPorts;
+    uint32_t gen = 0;
+    size_t peersUsed = 0;
+    SocketStats scan;
+
+    // Past PEER_LIMIT distinct peers new ones are not ranked, only counted as untracked.
+    // A table that large is mostly probed for peers it does not hold, so a bitmap of
+    // the tracked keys (8 KB, stays in L1) turns most of those misses away first.
+    void CountPeer(const uint32_t* words, bool v6) {
+        uint64_t key = words[0];
+        if (v6) key = ((((uint64_t)words[0] << 32 | words[1]) * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)words[2] << 32 | words[3])) | (1ull << 63);
+        uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+        uint64_t bit = (hash >> 20) & (((uint64_t)1 << FILTER_BITS) - 1);
+        bool maybeTracked = (peerFilter[bit >> 6] >> (bit & 63)) & 1;
+        if (peersUsed >= PEER_LIMIT && !maybeTracked) {
+            scan.untracked_peer_sockets++;
+            return;
+        }
+        size_t mask = PEER_SLOTS - 1;
+        for (size_t h = (size_t)(hash >> (64 - PEER_BITS));; h = (h + 1) & mask) {
+            Peer& p = peers[h];
+            if (p.gen != gen) {
+                if (peersUsed >= PEER_LIMIT) {
+                    scan.untracked_peer_sockets++;
+                    return;
+                }
+                peerFilter[bit >> 6] |= (uint64_t)1 << (bit & 63);
+                p.key = key;
+                p.count = 1;
+                p.gen = gen;
+                peerAddrs[h].v6 = v6;
+                memcpy(peerAddrs[h].words, words, sizeof(peerAddrs[h].words));
+                peersUsed++;
+                return;
+            }
+            if (p.key == key) {
+                p.count++;
+                return;
+            }
+        }
+    }
+
+    void CountPort(uint32_t port) {
+        if (portGen[port] != gen) {
+            portGen[port] = gen;
+            portCount[port] = 0;
+            touchedPorts.push_back((uint16_t)port);
+        }
+        portCount[port]++;
+    }
+
+    // "  sl  local_address rem_address   st tx_queue:rx_queue ..." with addresses as
+    // 8 (v4) or 32 (v6) hex digits, ports as 4, the state as 2.
+    void ParseRows(const char* data, size_t size, bool v6, bool tcp) {
+        const size_t addrLen = v6 ? 32 : 8;
+        const size_t remOff = addrLen + 6;
+        const size_t stOff = remOff + addrLen + 6;
+        const size_t queueOff = stOff + 3;
+        const size_t minLen = queueOff + 17;
+
+        TextScanner s(data, size);
+        while (!s.AtEnd()) {
+            s.SkipTo(':');
+            if (!s.Skip(':')) break;
+            s.SkipBlanks();
+            const char* p = s.Pos();
+            s.SkipLine();
+            if ((size_t)(s.Pos() - p) < minLen || p[addrLen] != ':' || p[remOff + addrLen] != ':') continue;
+            scan.scan_rows++;
+
+            uint32_t state = HexNibble(p[stOff]) << 4 | HexNibble(p[stOff + 1]);
+            if (tcp) {
+                scan.tcp_total++;
+                if (state < (uint32_t)TCP_STATE_COUNT) scan.tcp_state[state]++;
+                if (state == TCP_LISTEN) continue;
+
+                uint32_t words[4] = { 0 };
+                for (size_t w = 0; w < addrLen / 8; w++) words[w] = Hex8(p + remOff + w * 8);
+                // v4-mapped v6 peers (::ffff:a.b.c.d) count as the v4 address.
+                bool mapped = v6 && words[0] == 0 && words[1] == 0 && words[2] == htonl(0xFFFF);
+                if (mapped) words[0] = words[3];
+                CountPeer(words, v6 && !mapped);
+                CountPort(Hex4(p + addrLen + 1));
+            }
+            else {
+                scan.udp_total++;
+                scan.udp_rx_queue_kb += (float)Hex8(p + queueOff + 9) / 1024.0f;
+                // drops is the last column.
+                const char* end = s.Pos() - 1;
+                while (end > p && (*end == '\n' || *end == ' ')) end--;
+                const char* num = end;
+                while (num > p && num[-1] != ' ') num--;
+                scan.udp_drops += TextScanner(num, (size_t)(end - num) + 1).U64();
+            }
+        }
+    }
+
+    static void FormatPeer(const PeerAddr& p, char* out, size_t size) {
+        if (!p.v6) {
+            snprintf(out, size, "%u.%u.%u.%u", p.words[0] & 0xFF, (p.words[0] >> 8) & 0xFF, (p.words[0] >> 16) & 0xFF, p.words[0] >> 24);
+            return;
+        }
+        unsigned char bytes[16];
+        memcpy(bytes, p.words, sizeof(bytes));
+        if (!inet_ntop(AF_INET6, bytes, out, (socklen_t)size)) out[0] = '\0';
+    }
+
+    void CollectTop() {
+        TopN<SOCKET_TOP> top;
+        for (size_t h = 0; h < peers.size(); h++) {
+            if (peers[h].gen == gen) top.Offer((float)peers[h].count, (int)h);
+        }
+        scan.top_peer_count = top.Count();
+        for (int k = 0; k < top.Count(); k++) {
+            FormatPeer(peerAddrs[top[k]], scan.top_peers[k].addr, sizeof(scan.top_peers[k].addr));
+            scan.top_peers[k].count = (int)peers[top[k]].count;
+        }
+        scan.distinct_peers = (int)peersUsed;
+
+        top.Clear();
+        for (uint16_t port : touchedPorts) top.Offer((float)portCount[port], port);
+        scan.top_port_count = top.Count();
+        for (int k = 0; k < top.Count(); k++) {
+            scan.top_ports[k].port = (uint16_t)top[k];
+            scan.top_ports[k].count = (int)portCount[top[k]];
+        }
+    }
+
+    void BeginScan() {
+        gen++;
+        peersUsed = 0;
+        std::fill(peerFilter.begin(), peerFilter.end(), 0);
+        touchedPorts.clear();
+        scan = SocketStats();
+        scan.available = true;
+        scanTable = 0;
+        scanHeader = true;
+        scanBytes = 0;
+        scanUs = 0.0f;
+        tables[0].Rewind();
+    }
+
+    // Parses roughly `budget` more bytes of the tables, carrying on where the last
+    // call stopped. A finished pass is published to `last` and the next one begun.
+    void ContinueScan(size_t budget) {
+        auto start = std::chrono::steady_clock::now();
+        size_t done = 0;
+        bool finished = false;
+        while (done < budget) {
+            if (scanTable == T_TABLE_COUNT) {
+                finished = true;
+                break;
+            }
+            const char* data;
+            size_t size;
+            if (!tables[scanTable].IsOpen() || !tables[scanTable].Next(data, size)) {
+                if (++scanTable < T_TABLE_COUNT) tables[scanTable].Rewind();
+                scanHeader = true;
+                continue;
+            }
+            done += size;
+            if (scanHeader) {
+                const char* nl = (const char*)memchr(data, '\n', size);
+                size_t skip = nl ? (size_t)(nl - data) + 1 : size;
+                data += skip;
+                size -= skip;
+                scanHeader = false;
+            }
+            ParseRows(data, size, scanTable == T_TCP6 || scanTable == T_UDP6, scanTable == T_TCP || scanTable == T_TCP6);
+        }
+        scanBytes += done;
+        if (finished) CollectTop();
+        scanUs += std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (!finished) return;
+
+        scan.scan_us = scanUs;
+        last = scan;
+        lastScanBytes = scanBytes;
+        BeginScan();
+    }
+
+    // Two-line blocks: "Tcp: RtoAlgorithm RtoMin ... RetransSegs ..." then the values.
+    void SampleSnmp(SocketStats& out) {
+        uint64_t raw[C_COUNTER_COUNT] = { 0 };
+        TextScanner s(snmp);
+        while (!s.AtEnd()) {
+            bool tcp = s.StartsWith("Tcp:", 4);
+            bool udp = s.StartsWith("Udp:", 4);
+            if (!tcp && !udp) { s.SkipLine(); continue; }
+
+            TextScanner names(s.Pos() + 4, (size_t)(s.End() - s.Pos() - 4));
+            s.SkipLine();
+            if (!s.Consume(tcp ? "Tcp:" : "Udp:", 4)) continue;
+            for (;;) {
+                const char* name;
+                size_t len = names.Word(name);
+                if (len == 0) break;
+                uint64_t v = (uint64_t)s.I64();
+                if (tcp && len == 7 && memcmp(name, "OutSegs", 7) == 0) raw[C_OUT_SEGS] = v;
+                else if (tcp && len == 11 && memcmp(name, "RetransSegs", 11) == 0) raw[C_RETRANS] = v;
+                else if (tcp && len == 6 && memcmp(name, "InErrs", 6) == 0) raw[C_IN_ERRS] = v;
+                else if (tcp && len == 7 && memcmp(name, "OutRsts", 7) == 0) raw[C_OUT_RSTS] = v;
+                else if (udp && len == 8 && memcmp(name, "InErrors", 8) == 0) raw[C_UDP_IN_ERRORS] = v;
+                else if (udp && len == 12 && memcmp(name, "RcvbufErrors", 12) == 0) raw[C_UDP_RCVBUF] = v;
+            }
+            s.SkipLine();
+        }
+
+        float outSegs = rates.Rate(C_OUT_SEGS, raw[C_OUT_SEGS]);
+        out.retrans_per_s = rates.Rate(C_RETRANS, raw[C_RETRANS]);
+        out.retrans_percent = outSegs > 0.0f ? std::min(100.0f, out.retrans_per_s * 100.0f / outSegs) : 0.0f;
+        out.in_errs_per_s = rates.Rate(C_IN_ERRS, raw[C_IN_ERRS]);
+        out.out_rsts_per_s = rates.Rate(C_OUT_RSTS, raw[C_OUT_RSTS]);
+        out.udp_in_errors_per_s = rates.Rate(C_UDP_IN_ERRORS, raw[C_UDP_IN_ERRORS]);
+        out.udp_rcvbuf_errors_per_s = rates.Rate(C_UDP_RCVBUF, raw[C_UDP_RCVBUF]);
+    }
+
+public:
+    const char* Name() const override { return "sockets"; }
+
+    bool Init() override {
+        bool any = false;
+        for (int t = 0; t < T_TABLE_COUNT; t++) any |= tables[t].Open(TABLE_PATHS[t]);
+        if (!any) return false;
+        snmp.Open("/proc/net/snmp", 8192);
+        rates.Resize(C_COUNTER_COUNT);
+
+        Peer empty = {};
+        peers.assign(PEER_SLOTS, empty);
+        peerAddrs.assign(PEER_SLOTS, PeerAddr());
+        peerFilter.assign(((size_t)1 << FILTER_BITS) / 64, 0);
+        portCount.assign(65536, 0);
+        portGen.assign(65536, 0);
+        touchedPorts.reserve(65536);
+
+        // The first pass runs whole so the first sample has a table to show.
+        BeginScan();
+        ContinueScan(SIZE_MAX);
+        return true;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        ContinueScan(lastScanBytes / TABLE_PERIOD + 1);
+        snap.sockets = last;
+        rates.Begin();
+        if (snmp.Read()) SampleSnmp(snap.sockets);
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "tcp_state", "" });
+        out.push_back({ "tcp_total", "" });
+        out.push_back({ "tcp_top_peer", "" });
+        out.push_back({ "tcp_top_port", "" });
+        out.push_back({ "udp_total", "" });
+        out.push_back({ "udp_rx_queue", "KB" });
+        out.push_back({ "udp_drops", "" });
+        out.push_back({ "tcp_retrans", "1/s" });
+        out.push_back({ "tcp_retrans_percent", "%" });
+        out.push_back({ "tcp_in_errs", "1/s" });
+        out.push_back({ "tcp_out_rsts", "1/s" });
+        out.push_back({ "udp_in_errors", "1/s" });
+        out.push_back({ "udp_rcvbuf_errors", "1/s" });
+        out.push_back({ "socket_scan", "us" });
+    }
+};
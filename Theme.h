@@ -34,6 +34,10 @@ public:
     static constexpr ImVec4 Col_GPU_End = ImVec4(0.9f, 0.2f, 0.6f, 1.0f);
     static constexpr ImVec4 Col_RAM_Start = ImVec4(1.0f, 0.5f, 0.2f, 1.0f);
     static constexpr ImVec4 Col_RAM_End = ImVec4(1.0f, 0.8f, 0.3f, 1.0f);
+    static constexpr ImVec4 Col_DISK_Start = ImVec4(0.2f, 0.8f, 0.4f, 1.0f);
+    static constexpr ImVec4 Col_DISK_End = ImVec4(0.6f, 1.0f, 0.4f, 1.0f);
+    static constexpr ImVec4 Col_NET_Start = ImVec4(0.2f, 0.4f, 1.0f, 1.0f);
+    static constexpr ImVec4 Col_NET_End = ImVec4(0.5f, 0.8f, 1.0f, 1.0f);
 
     static void Setup() {
         ImGuiStyle& style = ImGui::GetStyle();
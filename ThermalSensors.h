@@ -0,0 +1,168 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <dirent.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+
+// Temperatures from /sys/class/hwmon and /sys/class/thermal. The sensor list is
+// discovered and labelled once; afterwards each sensor is re-read from its open fd
+// only when its period (in sampler ticks) comes due.
+class ThermalProvider : public SensorProvider {
+private:
+    struct Sensor {
+        TempSensor info;
+        int slot = -1;
+        int period = 1;
+        int due = 0;
+    };
+
+    std::vector<Sensor> sensors;
+    SysValueSet values;
+    int tick = 0;
+
+    // NVMe temperature reads issue an admin command to the drive, so they are the slowest.
+    static int PeriodFor(TempKind kind) {
+        switch (kind) {
+        case TEMP_CPU_PACKAGE:
+        case TEMP_CPU_CORE: return 5;
+        case TEMP_GPU: return 5;
+        case TEMP_BOARD: return 10;
+        case TEMP_NVME: return 25;
+        default: return 10;
+        }
+    }
+
+    static bool Is(const char* s, const char* prefix) {
+        return strncmp(s, prefix, strlen(prefix)) == 0;
+    }
+
+    static TempKind Classify(const char* chip, const char* label) {
+        if (Is(chip, "coretemp")) return Is(label, "Package") ? TEMP_CPU_PACKAGE : TEMP_CPU_CORE;
+        if (Is(chip, "k10temp") || Is(chip, "zenpower")) return Is(label, "Tccd") ? TEMP_CPU_CORE : TEMP_CPU_PACKAGE;
+        if (Is(chip, "x86_pkg_temp") || Is(chip, "cpu_thermal") || Is(chip, "cpu-thermal")) return TEMP_CPU_PACKAGE;
+        if (Is(chip, "nvme")) return TEMP_NVME;
+        if (Is(chip, "amdgpu") || Is(chip, "radeon") || Is(chip, "nouveau") || Is(chip, "i915") || Is(chip, "xe")) return TEMP_GPU;
+        if (Is(chip, "nct") || Is(chip, "it87") || Is(chip, "w83") || Is(chip, "f71") || Is(chip, "acpitz") ||
+            Is(chip, "asus") || Is(chip, "gigabyte") || Is(chip, "dell_smm")) return TEMP_BOARD;
+        return TEMP_OTHER;
+    }
+
+    static void ReadText(const std::string& path, char* out, size_t size) {
+        out[0] = '\0';
+        ProcFile f;
+        if (!f.Open(path.c_str(), 128) || !f.Read()) return;
+        size_t n = std::min(f.Size(), size - 1);
+        memcpy(out, f.Data(), n);
+        out[n] = '\0';
+        if (char* nl = strchr(out, '\n')) *nl = '\0';
+    }
+
+    void AddSensor(const std::string& input, const char* chip, const char* label, TempKind kind) {
+        int slot = values.Add(input.c_str());
+        if (slot < 0) return;
+        Sensor s;
+        s.slot = slot;
+        s.info.kind = kind;
+        if (label[0]) snprintf(s.info.label, sizeof(s.info.label), "%s: %s", chip, label);
+        else snprintf(s.info.label, sizeof(s.info.label), "%s", chip);
+        s.period = PeriodFor(kind);
+        s.due = (int)sensors.size() % s.period;
+        sensors.push_back(s);
+    }
+
+    static std::vector<std::string> List(const char* dir, const char* prefix) {
+        std::vector<std::string> names;
+        if (DIR* d = OpenSysDir(dir)) {
+            while (dirent* e = readdir(d)) {
+                if (Is(e->d_name, prefix)) names.push_back(e->d_name);
+            }
+            closedir(d);
+        }
+        std::sort(names.begin(), names.end(), [prefix](const std::string& a, const std::string& b) {
+            size_t n = strlen(prefix);
+            return atoi(a.c_str() + n) < atoi(b.c_str() + n);
+        });
+        return names;
+    }
+
+    void DiscoverHwmon(std::vector<std::string>& chips) {
+        for (const std::string& hw : List("/sys/class/hwmon", "hwmon")) {
+            std::string base = "/sys/class/hwmon/" + hw;
+            char chip[32];
+            ReadText(base + "/name", chip, sizeof(chip));
+            if (!chip[0]) continue;
+            chips.push_back(chip);
+
+            for (const std::string& f : List(base.c_str(), "temp")) {
+                size_t us = f.find('_');
+                if (us == std::string::npos || f.compare(us, std::string::npos, "_input") != 0) continue;
+                std::string stem = base + "/" + f.substr(0, us);
+                char label[40];
+                ReadText(stem + "_label", label, sizeof(label));
+                AddSensor(stem + "_input", chip, label, Classify(chip, label));
+            }
+        }
+    }
+
+    // Zones that also registered a hwmon device (acpitz, most GPUs) were already added.
+    void DiscoverThermalZones(const std::vector<std::string>& chips) {
+        for (const std::string& zone : List("/sys/class/thermal", "thermal_zone")) {
+            std::string base = "/sys/class/thermal/" + zone;
+            char type[32];
+            ReadText(base + "/type", type, sizeof(type));
+            if (!type[0] || std::find(chips.begin(), chips.end(), type) != chips.end()) continue;
+            AddSensor(base + "/temp", type, "", Classify(type, ""));
+        }
+    }
+
+public:
+    const char* Name() const override { return "thermal"; }
+
+    bool Init() override {
+        std::vector<std::string> chips;
+        DiscoverHwmon(chips);
+        DiscoverThermalZones(chips);
+        return !sensors.empty();
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        snap.temps.resize(sensors.size());
+        float cpuPackage = 0.0f, cpuCore = 0.0f, nvme = 0.0f, board = 0.0f;
+
+        for (size_t i = 0; i < sensors.size(); i++) {
+            Sensor& s = sensors[i];
+            if (tick >= s.due) {
+                s.due = tick + s.period;
+                if (values.Read((size_t)s.slot)) s.info.celsius = (float)values.Value((size_t)s.slot) / 1000.0f;
+            }
+            snap.temps[i] = s.info;
+
+            float c = s.info.celsius;
+            switch (s.info.kind) {
+            case TEMP_CPU_PACKAGE: cpuPackage = std::max(cpuPackage, c); break;
+            case TEMP_CPU_CORE: cpuCore = std::max(cpuCore, c); break;
+            case TEMP_NVME: nvme = std::max(nvme, c); break;
+            case TEMP_BOARD: board = std::max(board, c); break;
+            default: break;
+            }
+        }
+        tick++;
+
+        snap.cpu_temp = cpuPackage > 0.0f ? cpuPackage : cpuCore;
+        snap.nvme_temp_max = nvme;
+        snap.board_temp = board;
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "temp_sensor", "C" });
+        out.push_back({ "cpu_temp", "C" });
+        out.push_back({ "nvme_temp_max", "C" });
+        out.push_back({ "board_temp", "C" });
+    }
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+
+// Single-producer / single-consumer triple buffer. The writer fills WriteBuffer()
+// and Publish()es it; the reader always gets the most recent complete slot.
+// Both sides are wait-free: each only ever does one atomic exchange.
+template <typename T>
+class TripleBuffer {
+private:
+    static const unsigned INDEX_MASK = 0x3;
+    static const unsigned DIRTY = 0x4;
+
+    T slots[3];
+    std::atomic<unsigned> middle{ 1 };
+    unsigned back = 0;
+    unsigned front = 2;
+
+public:
+    T& WriteBuffer() { return slots[back]; }
+
+    void Publish() {
+        back = middle.exchange(back | DIRTY, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    bool HasNew() const {
+        return (middle.load(std::memory_order_acquire) & DIRTY) != 0;
+    }
+
+    // The returned reference stays valid and unchanged until the next Read().
+    const T& Read() {
+        if (HasNew()) {
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+        return slots[front];
+    }
+
+    const T& Latest() const { return slots[front]; }
+};
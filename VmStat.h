@@ -0,0 +1,143 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <dirent.h>
+#include "SensorProvider.h"
+#include "ProcReader.h"
+#include "Rates.h"
+
+// Paging / reclaim counters from /proc/vmstat and compression totals from every
+// zram device's mm_stat. Raw counters go through a RateStage.
+class VmStatProvider : public SensorProvider {
+private:
+    enum Counter {
+        VM_PGFAULT, VM_PGMAJFAULT, VM_PSWPIN, VM_PSWPOUT, VM_ZSWPIN, VM_ZSWPOUT,
+        VM_PGSCAN_KSWAPD, VM_PGSCAN_DIRECT, VM_PGSCAN_KHUGEPAGED,
+        VM_PGSTEAL_KSWAPD, VM_PGSTEAL_DIRECT, VM_PGSTEAL_KHUGEPAGED,
+        VM_COMPACT_STALL, VM_THP_FAULT_FALLBACK,
+        VM_COUNTER_COUNT
+    };
+
+    struct Key {
+        const char* name;
+        size_t len;
+    };
+
+    static constexpr Key KEYS[VM_COUNTER_COUNT] = {
+        { "pgfault", 7 }, { "pgmajfault", 10 }, { "pswpin", 6 }, { "pswpout", 7 },
+        { "zswpin", 6 }, { "zswpout", 7 },
+        { "pgscan_kswapd", 13 }, { "pgscan_direct", 13 }, { "pgscan_khugepaged", 17 },
+        { "pgsteal_kswapd", 14 }, { "pgsteal_direct", 14 }, { "pgsteal_khugepaged", 18 },
+        { "compact_stall", 13 }, { "thp_fault_fallback", 18 },
+    };
+
+    ProcFile vmstatFile;
+    std::vector<ProcFile> zramFiles;
+    RateStage rates;
+
+    // Only lines starting with these letters can hold a counter we want.
+    static bool Candidate(char c) {
+        return c == 'p' || c == 'z' || c == 'c' || c == 't';
+    }
+
+    void SampleVmstat(VmRates& vm) {
+        uint64_t raw[VM_COUNTER_COUNT] = { 0 };
+
+        TextScanner s(vmstatFile);
+        while (!s.AtEnd()) {
+            if (Candidate(s.Peek())) {
+                const char* word;
+                size_t len = s.Word(word);
+                for (int k = 0; k < VM_COUNTER_COUNT; k++) {
+                    if (KEYS[k].len == len && memcmp(KEYS[k].name, word, len) == 0) {
+                        raw[k] = s.U64();
+                        break;
+                    }
+                }
+            }
+            s.SkipLine();
+        }
+
+        vm.pgfault = rates.Rate(VM_PGFAULT, raw[VM_PGFAULT]);
+        vm.pgmajfault = rates.Rate(VM_PGMAJFAULT, raw[VM_PGMAJFAULT]);
+        vm.pswpin = rates.Rate(VM_PSWPIN, raw[VM_PSWPIN]);
+        vm.pswpout = rates.Rate(VM_PSWPOUT, raw[VM_PSWPOUT]);
+        vm.zswpin = rates.Rate(VM_ZSWPIN, raw[VM_ZSWPIN]);
+        vm.zswpout = rates.Rate(VM_ZSWPOUT, raw[VM_ZSWPOUT]);
+        vm.pgscan_kswapd = rates.Rate(VM_PGSCAN_KSWAPD, raw[VM_PGSCAN_KSWAPD]);
+        vm.pgscan_direct = rates.Rate(VM_PGSCAN_DIRECT, raw[VM_PGSCAN_DIRECT]);
+        vm.pgscan_khugepaged = rates.Rate(VM_PGSCAN_KHUGEPAGED, raw[VM_PGSCAN_KHUGEPAGED]);
+        vm.pgsteal_kswapd = rates.Rate(VM_PGSTEAL_KSWAPD, raw[VM_PGSTEAL_KSWAPD]);
+        vm.pgsteal_direct = rates.Rate(VM_PGSTEAL_DIRECT, raw[VM_PGSTEAL_DIRECT]);
+        vm.pgsteal_khugepaged = rates.Rate(VM_PGSTEAL_KHUGEPAGED, raw[VM_PGSTEAL_KHUGEPAGED]);
+        vm.compact_stall = rates.Rate(VM_COMPACT_STALL, raw[VM_COMPACT_STALL]);
+        vm.thp_fault_fallback = rates.Rate(VM_THP_FAULT_FALLBACK, raw[VM_THP_FAULT_FALLBACK]);
+    }
+
+    // mm_stat: orig_data_size compr_data_size mem_used_total mem_limit mem_used_max ... (bytes)
+    void SampleZram(VmRates& vm) {
+        uint64_t orig = 0, compr = 0, used = 0;
+        for (ProcFile& f : zramFiles) {
+            if (!f.Read()) continue;
+            TextScanner s(f);
+            orig += s.U64();
+            compr += s.U64();
+            used += s.U64();
+        }
+        vm.zram_devices = (int)zramFiles.size();
+        vm.zram_orig_mb = (float)orig / (1024.f * 1024.f);
+        vm.zram_compr_mb = (float)compr / (1024.f * 1024.f);
+        vm.zram_used_mb = (float)used / (1024.f * 1024.f);
+        vm.zram_ratio = compr ? (float)orig / (float)compr : 0.0f;
+    }
+
+public:
+    const char* Name() const override { return "vmstat"; }
+
+    bool Init() override {
+        if (!vmstatFile.Open("/proc/vmstat", 8192)) return false;
+        rates.Resize(VM_COUNTER_COUNT);
+
+        if (DIR* d = OpenSysDir("/sys/block")) {
+            while (dirent* e = readdir(d)) {
+                if (strncmp(e->d_name, "zram", 4) != 0) continue;
+                ProcFile f;
+                if (f.Open(("/sys/block/" + std::string(e->d_name) + "/mm_stat").c_str(), 256)) zramFiles.push_back(std::move(f));
+            }
+            closedir(d);
+        }
+        return true;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        rates.Begin();
+        if (vmstatFile.Read()) SampleVmstat(snap.vm);
+        if (!zramFiles.empty()) SampleZram(snap.vm);
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "vm_pgfault", "1/s" });
+        out.push_back({ "vm_pgmajfault", "1/s" });
+        out.push_back({ "vm_pswpin", "pages/s" });
+        out.push_back({ "vm_pswpout", "pages/s" });
+        out.push_back({ "vm_zswpin", "pages/s" });
+        out.push_back({ "vm_zswpout", "pages/s" });
+        out.push_back({ "vm_pgscan_kswapd", "pages/s" });
+        out.push_back({ "vm_pgscan_direct", "pages/s" });
+        out.push_back({ "vm_pgscan_khugepaged", "pages/s" });
+        out.push_back({ "vm_pgsteal_kswapd", "pages/s" });
+        out.push_back({ "vm_pgsteal_direct", "pages/s" });
+        out.push_back({ "vm_pgsteal_khugepaged", "pages/s" });
+        out.push_back({ "vm_compact_stall", "1/s" });
+        out.push_back({ "vm_thp_fault_fallback", "1/s" });
+        if (!zramFiles.empty()) {
+            out.push_back({ "zram_orig", "MB" });
+            out.push_back({ "zram_compr", "MB" });
+            out.push_back({ "zram_used", "MB" });
+            out.push_back({ "zram_ratio", "x" });
+        }
+    }
+};
@@ -0,0 +1,365 @@
+#pragma once
+
+#ifdef min
+#undef min
+#endif
+#ifdef max
+#undef max
+#endif
+
+#include <windows.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <pdh.h>
+#include <pdhmsg.h>
+#include "SensorProvider.h"
+#include "Nvml.h"
+
+#pragma comment(lib, "pdh.lib")
+
+#ifndef PDH_CSTATUS_VALID
+#define PDH_CSTATUS_VALID ((DWORD)0x00000000L)
+#endif
+#ifndef PDH_CSTATUS_NEW_DATA
+#define PDH_CSTATUS_NEW_DATA ((DWORD)0x00000001L)
+#endif
+
+typedef void* (*ADL_MAIN_MALLOC_CALLBACK)(int);
+typedef struct AdapterInfo {
+    int iSize; int iAdapterIndex; char strUDID[256]; int iBusNumber; int iDeviceNumber; int iFunctionNumber; int iVendorID;
+    char strAdapterName[256]; char strDisplayName[256]; int iPresent; int iExist; char strDriverPath[256]; char strDriverPathExt[256];
+    char strPNPString[256]; int iOSDisplayIndex;
+} AdapterInfo;
+
+typedef struct ADLPMActivity {
+    int iSize; int iEngineClock; int iMemoryClock; int iVddc; int iActivityPercent;
+    int iCurrentPerformanceLevel; int iCurrentBusSpeed; int iCurrentBusLanes; int iMaximumBusLanes; int iReserved;
+} ADLPMActivity;
+
+typedef struct ADLMemoryInfo {
+    long long iMemorySize; char strMemoryType[256]; long long iMemoryBandwidth;
+} ADLMemoryInfo;
+
+typedef int(*ADL_Main_Control_Create_t)(ADL_MAIN_MALLOC_CALLBACK, int);
+typedef int(*ADL_Main_Control_Destroy_t)();
+typedef int(*ADL_Adapter_NumberOfAdapters_Get_t)(int*);
+typedef int(*ADL_Adapter_AdapterInfo_Get_t)(AdapterInfo*, int);
+typedef int(*ADL_Overdrive5_CurrentActivity_Get_t)(int, ADLPMActivity*);
+typedef int(*ADL_Adapter_MemoryInfo_Get_t)(int, ADLMemoryInfo*);
+
+typedef struct ProcessorPerfInfo {
+    LARGE_INTEGER IdleTime; LARGE_INTEGER KernelTime; LARGE_INTEGER UserTime;
+    LARGE_INTEGER DpcTime; LARGE_INTEGER InterruptTime; ULONG InterruptCount;
+} ProcessorPerfInfo;
+
+typedef LONG(NTAPI* NtQuerySystemInformation_t)(ULONG, PVOID, ULONG, PULONG);
+static const ULONG SystemProcessorPerformanceInformationClass = 8;
+
+inline void* __stdcall ADL_Main_Memory_Alloc(int iSize) { return malloc(iSize); }
+
+
+inline ULONGLONG FT2ULL(FILETIME ft) {
+    ULARGE_INTEGER li;
+    li.LowPart = ft.dwLowDateTime;
+    li.HighPart = ft.dwHighDateTime;
+    return li.QuadPart;
+}
+
+class WinSensorProvider : public SensorProvider {
+private:
+    GpuSource gpuSource = SOURCE_NONE;
+
+    ULONGLONG lastIdle = 0;
+    ULONGLONG lastKernel = 0;
+    ULONGLONG lastUser = 0;
+    bool cpuInited = false;
+
+    NtQuerySystemInformation_t ntQuerySysInfo = nullptr;
+    std::vector<ProcessorPerfInfo> perfInfo;
+    CpuCoreEngine cores;
+
+    PDH_HQUERY gpuQuery = NULL;
+    PDH_HCOUNTER gpuCounter = NULL;
+    bool pdhGpuInit = false;
+    std::vector<BYTE> pdhRawBuffer;
+
+    NvmlGpus nvidia;
+
+    HMODULE hAdl = nullptr;
+    int amdAdapterIndex = -1;
+    ADL_Overdrive5_CurrentActivity_Get_t adlGetActivity = nullptr;
+    ADL_Adapter_MemoryInfo_Get_t adlGetMemInfo = nullptr;
+
+    float gpuVramTotal = 0.0f;
+    float ramTotalGb = 0.0f;
+
+public:
+    ~WinSensorProvider() override {
+        if (pdhGpuInit) PdhCloseQuery(gpuQuery);
+
+        if (hAdl) {
+            auto adlDestroy = (ADL_Main_Control_Destroy_t)GetProcAddress(hAdl, "ADL_Main_Control_Destroy");
+            if (adlDestroy) adlDestroy();
+            FreeLibrary(hAdl);
+        }
+    }
+
+    const char* Name() const override { return "win32"; }
+
+    bool Init() override {
+        InitCPU();
+
+        if (nvidia.Init()) gpuSource = SOURCE_NVIDIA;
+        else if (InitAMD()) gpuSource = SOURCE_AMD;
+        else if (InitUniversalGPU()) gpuSource = SOURCE_PDH;
+
+        MEMORYSTATUSEX memInfo;
+        memInfo.dwLength = sizeof(MEMORYSTATUSEX);
+        if (GlobalMemoryStatusEx(&memInfo)) {
+            ramTotalGb = (float)memInfo.ullTotalPhys / (1024.f * 1024.f * 1024.f);
+        }
+        return true;
+    }
+
+    void Sample(SensorSnapshot& snap) override {
+        MeasureCPU(snap);
+        MeasureGPU(snap);
+
+        MEMORYSTATUSEX memInfo;
+        memInfo.dwLength = sizeof(MEMORYSTATUSEX);
+        if (GlobalMemoryStatusEx(&memInfo)) {
+            snap.ram_usage_gb = (float)(memInfo.ullTotalPhys - memInfo.ullAvailPhys) / (1024.f * 1024.f * 1024.f);
+            snap.ram_percent = (float)memInfo.dwMemoryLoad;
+            snap.mem.used_no_cache_gb = snap.ram_usage_gb;
+            snap.mem.used_no_cache_percent = snap.ram_percent;
+        }
+        snap.ram_total_gb = ramTotalGb;
+    }
+
+    void Describe(std::vector<MetricDesc>& out) const override {
+        out.push_back({ "cpu_load", "%" });
+        if (ntQuerySysInfo) {
+            out.push_back({ "cpu_core_load", "%" });
+            out.push_back({ "cpu_core_user", "%" });
+            out.push_back({ "cpu_core_system", "%" });
+        }
+        if (gpuSource != SOURCE_NONE) out.push_back({ "gpu_load", "%" });
+        if (gpuSource == SOURCE_NVIDIA) {
+            out.push_back({ "gpu_temp", "C" });
+            out.push_back({ "gpu_vram_used", "GB" });
+            out.push_back({ "gpu_count", "" });
+            out.push_back({ "gpu_load_mean", "%" });
+            out.push_back({ "gpu_temp_mean", "C" });
+            out.push_back({ "gpu_power", "W" });
+            out.push_back({ "gpu_sm_clock", "MHz" });
+            out.push_back({ "gpu_mem_clock", "MHz" });
+            out.push_back({ "gpu_pcie_tx", "MB/s" });
+            out.push_back({ "gpu_pcie_rx", "MB/s" });
+            out.push_back({ "gpu_fan", "%" });
+            out.push_back({ "gpu_throttle_reasons", "mask" });
+        }
+        if (gpuSource == SOURCE_NVIDIA || gpuSource == SOURCE_AMD) out.push_back({ "gpu_vram_total", "GB" });
+        out.push_back({ "ram_usage_gb", "GB" });
+        out.push_back({ "ram_percent", "%" });
+        out.push_back({ "ram_total_gb", "GB" });
+    }
+
+private:
+    void InitCPU() {
+        FILETIME idle, kernel, user;
+        GetSystemTimes(&idle, &kernel, &user);
+
+        HMODULE ntdll = GetModuleHandle(L"ntdll.dll");
+        if (ntdll) ntQuerySysInfo = (NtQuerySystemInformation_t)GetProcAddress(ntdll, "NtQuerySystemInformation");
+
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        perfInfo.resize(si.dwNumberOfProcessors);
+        cores.Resize(si.dwNumberOfProcessors);
+    }
+
+    // Per-logical-CPU times for the calling thread's processor group. Kernel time includes idle.
+    void MeasureCores(SensorSnapshot& snap) {
+        if (!ntQuerySysInfo || perfInfo.empty()) return;
+
+        ULONG len = 0;
+        if (ntQuerySysInfo(SystemProcessorPerformanceInformationClass, perfInfo.data(),
+            (ULONG)(perfInfo.size() * sizeof(ProcessorPerfInfo)), &len) != 0) return;
+
+        size_t n = std::min(perfInfo.size(), (size_t)(len / sizeof(ProcessorPerfInfo)));
+        CpuTimesSoA& c = cores.Current();
+        for (size_t i = 0; i < n; i++) {
+            c.user[i] = (uint64_t)perfInfo[i].UserTime.QuadPart;
+            c.system[i] = (uint64_t)(perfInfo[i].KernelTime.QuadPart - perfInfo[i].IdleTime.QuadPart);
+            c.idle[i] = (uint64_t)perfInfo[i].IdleTime.QuadPart;
+        }
+        cores.Compute(snap.cpu_cores);
+    }
+
+    void MeasureCPU(SensorSnapshot& snap) {
+        MeasureCores(snap);
+
+        FILETIME idleFT, kernelFT, userFT;
+        if (!GetSystemTimes(&idleFT, &kernelFT, &userFT)) return;
+
+        ULONGLONG idle = FT2ULL(idleFT);
+        ULONGLONG kernel = FT2ULL(kernelFT);
+        ULONGLONG user = FT2ULL(userFT);
+
+        if (!cpuInited) {
+            lastIdle = idle;
+            lastKernel = kernel;
+            lastUser = user;
+            cpuInited = true;
+            snap.cpu_load = 0.0f;
+            return;
+        }
+
+        ULONGLONG idleDiff = idle - lastIdle;
+        ULONGLONG totalDiff = (kernel - lastKernel) + (user - lastUser);
+
+        lastIdle = idle;
+        lastKernel = kernel;
+        lastUser = user;
+
+        if (totalDiff == 0) return;
+
+        double cpu = (1.0 - (double)idleDiff / (double)totalDiff) * 100.0;
+
+        if (cpu < 0.0) cpu = 0.0;
+        if (cpu > 100.0) cpu = 100.0;
+
+        snap.cpu_load = (float)cpu;
+    }
+
+    bool InitAMD() {
+        hAdl = LoadLibrary(L"atiadlxx.dll");
+        if (!hAdl) hAdl = LoadLibrary(L"atiadlxy.dll");
+        if (!hAdl) return false;
+
+        auto adlCreate = (ADL_Main_Control_Create_t)GetProcAddress(hAdl, "ADL_Main_Control_Create");
+        auto adlNumAdapters = (ADL_Adapter_NumberOfAdapters_Get_t)GetProcAddress(hAdl, "ADL_Adapter_NumberOfAdapters_Get");
+        auto adlGetInfo = (ADL_Adapter_AdapterInfo_Get_t)GetProcAddress(hAdl, "ADL_Adapter_AdapterInfo_Get");
+        adlGetActivity = (ADL_Overdrive5_CurrentActivity_Get_t)GetProcAddress(hAdl, "ADL_Overdrive5_CurrentActivity_Get");
+        adlGetMemInfo = (ADL_Adapter_MemoryInfo_Get_t)GetProcAddress(hAdl, "ADL_Adapter_MemoryInfo_Get");
+
+        if (adlCreate && adlCreate(ADL_Main_Memory_Alloc, 1) == 0) {
+            int numAdapters = 0;
+            adlNumAdapters(&numAdapters);
+            if (numAdapters > 0) {
+                std::vector<AdapterInfo> infos(numAdapters);
+                if (adlGetInfo(infos.data(), sizeof(AdapterInfo) * numAdapters) == 0) {
+                    for (int i = 0; i < numAdapters; i++) {
+                        ADLPMActivity act = { 0 }; act.iSize = sizeof(ADLPMActivity);
+                        if (infos[i].iPresent && adlGetActivity && adlGetActivity(infos[i].iAdapterIndex, &act) == 0) {
+                            amdAdapterIndex = infos[i].iAdapterIndex;
+
+                            if (adlGetMemInfo) {
+                                ADLMemoryInfo memVal = { 0 };
+                                if (adlGetMemInfo(infos[i].iAdapterIndex, &memVal) == 0) {
+                                    gpuVramTotal = (float)memVal.iMemorySize / (1024.f * 1024.f * 1024.f);
+                                }
+                            }
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+        FreeLibrary(hAdl); hAdl = nullptr;
+        return false;
+    }
+
+    bool InitUniversalGPU() {
+        if (PdhOpenQuery(NULL, 0, &gpuQuery) == ERROR_SUCCESS) {
+            if (PdhAddEnglishCounter(gpuQuery, L"\\GPU Engine(*)\\Utilization Percentage", 0, &gpuCounter) != ERROR_SUCCESS) {
+                if (PdhAddCounter(gpuQuery, L"\\GPU Engine(*)\\Utilization Percentage", 0, &gpuCounter) != ERROR_SUCCESS) {
+                    PdhCloseQuery(gpuQuery);
+                    return false;
+                }
+            }
+            PdhCollectQueryData(gpuQuery);
+            pdhGpuInit = true;
+            return true;
+        }
+        return false;
+    }
+
+    void MeasureGPU(SensorSnapshot& snap) {
+        snap.gpu_source = gpuSource;
+        if (gpuSource == SOURCE_NVIDIA) {
+            nvidia.Sample(snap);
+            return;
+        }
+
+        float rawGpu = 0.0f;
+
+        if (gpuSource == SOURCE_AMD) {
+            if (adlGetActivity) {
+                ADLPMActivity act = { 0 }; act.iSize = sizeof(ADLPMActivity);
+                if (adlGetActivity(amdAdapterIndex, &act) == 0) rawGpu = (float)act.iActivityPercent;
+            }
+        }
+        else if (gpuSource == SOURCE_PDH && pdhGpuInit) {
+            PdhCollectQueryData(gpuQuery);
+
+            DWORD dwBufferSize = 0, dwItemCount = 0;
+            PdhGetFormattedCounterArray(gpuCounter, PDH_FMT_DOUBLE, &dwBufferSize, &dwItemCount, NULL);
+
+            if (dwBufferSize > 0) {
+                if (pdhRawBuffer.size() < dwBufferSize) pdhRawBuffer.resize(dwBufferSize);
+
+                PDH_FMT_COUNTERVALUE_ITEM* pItems = (PDH_FMT_COUNTERVALUE_ITEM*)pdhRawBuffer.data();
+
+                PDH_STATUS status = PdhGetFormattedCounterArray(gpuCounter, PDH_FMT_DOUBLE, &dwBufferSize, &dwItemCount, pItems);
+
+                if (status == ERROR_SUCCESS) {
+                    double maxLoad = 0.0;
+                    for (DWORD i = 0; i < dwItemCount; i++) {
+                        if (pItems[i].FmtValue.CStatus == PDH_CSTATUS_VALID) {
+                            if (pItems[i].FmtValue.doubleValue > maxLoad) maxLoad = pItems[i].FmtValue.doubleValue;
+                        }
+                    }
+                    rawGpu = (float)maxLoad;
+                }
+            }
+        }
+        snap.gpu_load = std::max(0.0f, std::min(100.0f, rawGpu));
+        snap.gpu_vram_total = gpuVramTotal;
+    }
+};
+
+inline uint64_t PlatformIoSyscalls() { return 0; }
+
+// Sampler sleep: a condition variable that Stop() signals. Windows providers have no
+// wake handles, so every pass runs on the period.
+class SamplerWaiter {
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+public:
+    void Init(const std::vector<int>&) {}
+
+    WakeReason WaitUntil(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return wake.wait_until(lock, deadline, [this] { return stopping; }) ? WAKE_STOP : WAKE_PERIOD;
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+    }
+};
+
+inline void CreatePlatformProviders(SensorProviderList& out) {
+    out.push_back(std::make_unique<WinSensorProvider>());
+}
@@ -0,0 +1,137 @@
+#!/usr/bin/env bash
+# Captures the /proc and /sys files read by the Linux sensor providers into a
+# directory tree that can be replayed with HWMON_SYSROOT=<dir>.
+#
+#   ./capture_sysroot.sh out/host-256c          # one snapshot
+#   ./capture_sysroot.sh out/host-256c 5 0.2    # 5 snapshots, 0.2 s apart (out/host-256c/0..4)
+#
+# Paths are stored under their logical names (sysfs class symlinks are resolved
+# into plain directories); /proc/<pid>/fd and DRM device/driver links are
+# recreated as symlinks.
+# Providers keep their files open, so a series is replayed by copying each
+# numbered snapshot over the root in turn (cp -r out/1/. root/) while running.
+
+set -u
+
+OUT=${1:?usage: capture_sysroot.sh <out-dir> [count] [interval-seconds]}
+COUNT=${2:-1}
+INTERVAL=${3:-0.2}
+
+PATTERNS=(
+    /proc/stat
+    /proc/meminfo
+    /proc/loadavg
+    /proc/schedstat
+    /proc/vmstat
+    /proc/pressure/cpu
+    /proc/pressure/memory
+    /proc/pressure/io
+    /proc/self/cgroup
+    /proc/diskstats
+    /sys/dev/block/*/partition
+    /sys/dev/block/*/device/uevent
+    /proc/net/dev
+    /sys/class/net/*/speed
+    /sys/class/net/*/device/uevent
+    /proc/net/tcp
+    /proc/net/tcp6
+    /proc/net/udp
+    /proc/net/udp6
+    /proc/net/snmp
+    /proc/interrupts
+    /proc/softirqs
+    /sys/class/drm/card*/device/driver
+    /sys/class/drm/card*/device/gpu_metrics
+    /sys/class/drm/card*/device/gpu_busy_percent
+    /sys/class/drm/card*/device/mem_info_vram_used
+    /sys/class/drm/card*/device/mem_info_vram_total
+    /sys/class/drm/card*/device/hwmon/hwmon*/temp1_input
+    /sys/class/drm/card*/gt/gt0/rc6_residency_ms
+    /sys/class/drm/card*/gt/gt0/rps_act_freq_mhz
+    /sys/class/drm/card*/gt/gt0/rps_cur_freq_mhz
+    /sys/class/drm/card*/gt/gt0/throttle_reason_status
+    /sys/class/drm/card*/power/rc6_residency_ms
+    /sys/class/drm/card*/gt_act_freq_mhz
+    /sys/class/drm/card*/gt_cur_freq_mhz
+    /sys/class/drm/card*/device/tile0/gt0/gtidle/idle_residency_ms
+    /sys/class/drm/card*/device/tile0/gt0/freq0/act_freq
+    /sys/class/drm/card*/device/tile0/gt0/freq0/cur_freq
+    /sys/class/drm/card*/device/tile0/gt0/freq0/throttle/status
+    /sys/class/hwmon/hwmon*/name
+    /sys/class/hwmon/hwmon*/temp*_input
+    /sys/class/hwmon/hwmon*/temp*_label
+    /sys/class/thermal/thermal_zone*/type
+    /sys/class/thermal/thermal_zone*/temp
+    /sys/devices/system/cpu/cpufreq/policy*/related_cpus
+    /sys/devices/system/cpu/cpufreq/policy*/scaling_cur_freq
+    /sys/devices/system/cpu/cpufreq/policy*/cpuinfo_max_freq
+    /sys/devices/system/cpu/cpu[0-9]*/cpufreq/scaling_cur_freq
+    /sys/devices/system/cpu/cpu[0-9]*/cpufreq/cpuinfo_max_freq
+    /sys/devices/system/cpu/cpu[0-9]*/topology/physical_package_id
+    /sys/devices/system/cpu/cpu[0-9]*/topology/core_id
+    /sys/devices/system/cpu/cpu[0-9]*/topology/core_cpus_list
+    /sys/devices/system/cpu/cpu[0-9]*/topology/thread_siblings_list
+    /sys/devices/system/cpu/cpu[0-9]*/cache/index*/level
+    /sys/devices/system/cpu/cpu[0-9]*/cache/index*/shared_cpu_list
+    /sys/devices/cpu_core/cpus
+    /sys/devices/cpu_atom/cpus
+    /sys/devices/system/cpu/cpu[0-9]*/thermal_throttle/core_throttle_count
+    /sys/devices/system/cpu/cpu[0-9]*/thermal_throttle/package_throttle_count
+    /sys/devices/system/cpu/cpu[0-9]*/cpuidle/state*/name
+    /sys/devices/system/cpu/cpu[0-9]*/cpuidle/state*/time
+    /sys/devices/system/cpu/cpu[0-9]*/cpuidle/state*/usage
+    /sys/block/zram*/mm_stat
+    /proc/[0-9]*/fd/*
+    /proc/[0-9]*/fdinfo/*
+    /proc/[0-9]*/comm
+    /proc/[0-9]*/stat
+)
+
+# cgroup v2 files are copied at any depth below /sys/fs/cgroup.
+CGROUP_FILES=(cgroup.controllers memory.max memory.current cpu.max cpu.stat io.stat)
+
+copy_file() {
+    local src=$1 dst=$2
+    [ -r "$src" ] || return 0
+    mkdir -p "$(dirname "$dst")"
+    # procfs/sysfs report size 0, so stream the content instead of cp.
+    cat "$src" > "$dst" 2>/dev/null || rm -f "$dst"
+}
+
+copy_link() {
+    local src=$1 dst=$2
+    mkdir -p "$(dirname "$dst")"
+    ln -sfn "$(readlink "$src")" "$dst" 2>/dev/null
+}
+
+capture() {
+    local dest=$1
+    mkdir -p "$dest"
+    for pattern in "${PATTERNS[@]}"; do
+        for path in $pattern; do
+            if [ -L "$path" ] && [[ "$path" == /proc/*/fd/* || "$path" == */device/driver ]]; then
+                copy_link "$path" "$dest$path"
+            elif [ -f "$path" ]; then
+                copy_file "$path" "$dest$path"
+            fi
+        done
+    done
+    if [ -f /sys/fs/cgroup/cgroup.controllers ]; then
+        for name in "${CGROUP_FILES[@]}"; do
+            find /sys/fs/cgroup -name "$name" 2>/dev/null | while read -r path; do
+                copy_file "$path" "$dest$path"
+            done
+        done
+    fi
+}
+
+if [ "$COUNT" -le 1 ]; then
+    capture "$OUT"
+else
+    for ((i = 0; i < COUNT; i++)); do
+        capture "$OUT/$i"
+        sleep "$INTERVAL"
+    done
+fi
+
+echo "captured into $OUT"
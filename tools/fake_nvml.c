@@ -0,0 +1,232 @@
+/*
+ * A stand-in for libnvidia-ml.so.1 that exports every entry point NvmlGpus
+ * resolves and answers from a script instead of a driver, so the NVIDIA path
+ * (multi-GPU enumeration, the sample ring, the power/clock/PCIe/fan/throttle
+ * calls) can be exercised on a machine without an NVIDIA card:
+ *
+ *   make -C tools libfake_nvml.so
+ *   HWMON_NVML_LIB=$PWD/tools/libfake_nvml.so tools/hwmon_bench -n 20
+ *
+ * $FAKE_NVML_GPUS sets the device count (default 2). $FAKE_NVML_SCRIPT names a
+ * file of steps, one per line:
+ *
+ *   load mem_load temp_c power_mw sm_mhz mem_mhz fan_pct throttle_hex tx_kbps rx_kbps
+ *
+ * Blank lines and lines starting with '#' are skipped. Each device advances one
+ * step per nvmlDeviceGetUtilizationRates call (once per sampler tick) and wraps
+ * at the end; device N starts N steps in so cards differ. Without a script a
+ * built-in four-step ramp is used. Every step also pushes one entry into each
+ * device's power and clock sample rings, so nvmlDeviceGetSamples returns new
+ * data once per tick and NVML_ERROR_NOT_FOUND otherwise, like the driver.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NVML_SUCCESS 0
+#define NVML_ERROR_UNINITIALIZED 1
+#define NVML_ERROR_INVALID_ARGUMENT 2
+#define NVML_ERROR_NOT_SUPPORTED 3
+#define NVML_ERROR_INSUFFICIENT_SIZE 7
+#define NVML_ERROR_NOT_FOUND 6
+
+#define MAX_GPUS 16
+#define MAX_STEPS 256
+#define RING 8
+
+typedef struct { unsigned int gpu, memory; } Utilization;
+typedef struct { unsigned long long total, free, used; } Memory;
+typedef struct { unsigned long long timeStamp; unsigned long long value; } Sample;
+
+enum { S_POWER, S_SM, S_MEM, S_COUNT };
+
+typedef struct {
+    unsigned int load, memLoad, temp, powerMw, smMhz, memMhz, fan;
+    unsigned long long throttle;
+    unsigned int txKbps, rxKbps;
+} Step;
+
+typedef struct {
+    int index;
+    int step;
+    unsigned long long stamp;
+} Device;
+
+static const Step BUILTIN[] = {
+    { 5, 2, 38, 21000, 210, 405, 0, 0x1ULL, 120, 80 },
+    { 62, 35, 61, 145000, 1755, 7000, 42, 0x0ULL, 95000, 410000 },
+    { 99, 71, 83, 249000, 1620, 7000, 78, 0x4ULL, 180000, 720000 },
+    { 99, 74, 88, 251000, 1395, 7000, 100, 0x60ULL, 175000, 690000 },
+};
+
+static Step steps[MAX_STEPS];
+static int stepCount;
+static Device devices[MAX_GPUS];
+static int deviceCount;
+static int initialized;
+
+static void LoadScript(void) {
+    const char* path = getenv("FAKE_NVML_SCRIPT");
+    FILE* f = path ? fopen(path, "r") : NULL;
+    char line[256];
+    stepCount = 0;
+    while (f && stepCount < MAX_STEPS && fgets(line, sizeof(line), f)) {
+        Step s;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%u %u %u %u %u %u %u %llx %u %u", &s.load, &s.memLoad, &s.temp, &s.powerMw,
+                &s.smMhz, &s.memMhz, &s.fan, &s.throttle, &s.txKbps, &s.rxKbps) == 10)
+            steps[stepCount++] = s;
+    }
+    if (f) fclose(f);
+    if (stepCount == 0) {
+        stepCount = (int)(sizeof(BUILTIN) / sizeof(BUILTIN[0]));
+        memcpy(steps, BUILTIN, sizeof(BUILTIN));
+    }
+}
+
+static const Step* Current(const Device* d) {
+    return &steps[(d->step + d->index) % stepCount];
+}
+
+static Device* Lookup(void* handle) {
+    Device* d = (Device*)handle;
+    if (!initialized || d < devices || d >= devices + deviceCount) return NULL;
+    return d;
+}
+
+int nvmlInit_v2(void) {
+    const char* n = getenv("FAKE_NVML_GPUS");
+    int i;
+    deviceCount = n ? atoi(n) : 2;
+    if (deviceCount < 0) deviceCount = 0;
+    if (deviceCount > MAX_GPUS) deviceCount = MAX_GPUS;
+    for (i = 0; i < deviceCount; i++) {
+        devices[i].index = i;
+        devices[i].step = 0;
+        devices[i].stamp = 1000000ULL;
+    }
+    LoadScript();
+    initialized = 1;
+    return NVML_SUCCESS;
+}
+
+int nvmlInit(void) { return nvmlInit_v2(); }
+
+int nvmlShutdown(void) {
+    initialized = 0;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetCount_v2(unsigned int* count) {
+    if (!initialized) return NVML_ERROR_UNINITIALIZED;
+    if (!count) return NVML_ERROR_INVALID_ARGUMENT;
+    *count = (unsigned int)deviceCount;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetCount(unsigned int* count) { return nvmlDeviceGetCount_v2(count); }
+
+int nvmlDeviceGetHandleByIndex_v2(unsigned int index, void** handle) {
+    if (!initialized) return NVML_ERROR_UNINITIALIZED;
+    if (!handle || index >= (unsigned int)deviceCount) return NVML_ERROR_INVALID_ARGUMENT;
+    *handle = &devices[index];
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetName(void* handle, char* name, unsigned int length) {
+    Device* d = Lookup(handle);
+    if (!d || !name || length == 0) return NVML_ERROR_INVALID_ARGUMENT;
+    snprintf(name, length, "Fake NVIDIA GPU %d", d->index);
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetUtilizationRates(void* handle, Utilization* out) {
+    Device* d = Lookup(handle);
+    if (!d || !out) return NVML_ERROR_INVALID_ARGUMENT;
+    d->step++;
+    d->stamp += 100000ULL;
+    out->gpu = Current(d)->load;
+    out->memory = Current(d)->memLoad;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetTemperature(void* handle, int sensor, unsigned int* temp) {
+    Device* d = Lookup(handle);
+    if (!d || !temp || sensor != 0) return NVML_ERROR_INVALID_ARGUMENT;
+    *temp = Current(d)->temp;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetMemoryInfo(void* handle, Memory* out) {
+    Device* d = Lookup(handle);
+    if (!d || !out) return NVML_ERROR_INVALID_ARGUMENT;
+    out->total = (8ULL << 30) * (unsigned long long)(d->index + 1);
+    out->used = out->total / 100 * Current(d)->memLoad;
+    out->free = out->total - out->used;
+    return NVML_SUCCESS;
+}
+
+/* One entry per step since the last timestamp the caller saw, newest value only
+ * (older steps are already gone from the script's point of view). */
+int nvmlDeviceGetSamples(void* handle, int type, unsigned long long lastSeen, int* valueType,
+        unsigned int* count, Sample* samples) {
+    Device* d = Lookup(handle);
+    const Step* s;
+    if (!d || !valueType || !count) return NVML_ERROR_INVALID_ARGUMENT;
+    if (type != 0 && type != 5 && type != 6) return NVML_ERROR_NOT_SUPPORTED;
+    *valueType = 3; /* NVML_VALUE_ULONGLONG */
+    if (!samples) {
+        *count = RING;
+        return NVML_SUCCESS;
+    }
+    if (*count == 0) return NVML_ERROR_INSUFFICIENT_SIZE;
+    if (d->stamp <= lastSeen) return NVML_ERROR_NOT_FOUND;
+    s = Current(d);
+    samples[0].timeStamp = d->stamp;
+    samples[0].value = type == 0 ? s->powerMw : type == 5 ? s->smMhz : s->memMhz;
+    *count = 1;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetPowerUsage(void* handle, unsigned int* mw) {
+    Device* d = Lookup(handle);
+    if (!d || !mw) return NVML_ERROR_INVALID_ARGUMENT;
+    *mw = Current(d)->powerMw;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetClockInfo(void* handle, int type, unsigned int* mhz) {
+    Device* d = Lookup(handle);
+    if (!d || !mhz) return NVML_ERROR_INVALID_ARGUMENT;
+    if (type == 0 || type == 1) *mhz = Current(d)->smMhz;
+    else if (type == 2) *mhz = Current(d)->memMhz;
+    else return NVML_ERROR_NOT_SUPPORTED;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetPcieThroughput(void* handle, int counter, unsigned int* kbps) {
+    Device* d = Lookup(handle);
+    if (!d || !kbps) return NVML_ERROR_INVALID_ARGUMENT;
+    if (counter == 0) *kbps = Current(d)->txKbps;
+    else if (counter == 1) *kbps = Current(d)->rxKbps;
+    else return NVML_ERROR_NOT_SUPPORTED;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetFanSpeed(void* handle, unsigned int* percent) {
+    Device* d = Lookup(handle);
+    if (!d || !percent) return NVML_ERROR_INVALID_ARGUMENT;
+    *percent = Current(d)->fan;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetCurrentClocksEventReasons(void* handle, unsigned long long* reasons) {
+    Device* d = Lookup(handle);
+    if (!d || !reasons) return NVML_ERROR_INVALID_ARGUMENT;
+    *reasons = Current(d)->throttle;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetCurrentClocksThrottleReasons(void* handle, unsigned long long* reasons) {
+    return nvmlDeviceGetCurrentClocksEventReasons(handle, reasons);
+}
@@ -0,0 +1,102 @@
+// Runs the Linux sensor providers N times and prints what each pass cost: wall
+// time and the syscalls counted by ProcReader, per provider and in total (the
+// same figures Hardware publishes as sample_us / sample_syscalls). Point it at a
+// captured tree with HWMON_SYSROOT to compare changes on a fixed input. The socket
+// tables are parsed a slice per sample, so their cost is also printed per full
+// pass, against the 10 ms a pass should stay under.
+//
+//   HWMON_SYSROOT=fixtures/build-host ./hwmon_bench -n 100 -i 0
+//   ./hwmon_bench -p sockets -n 25
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../LinuxSensors.h"
+
+static const double SOCKET_PASS_TARGET_US = 10000.0;
+
+struct ProviderCost {
+    double totalUs = 0.0;
+    double maxUs = 0.0;
+    uint64_t syscalls = 0;
+};
+
+static void Usage() {
+    fprintf(stderr, "usage: hwmon_bench [-n samples] [-i interval-ms] [-p provider]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    int samples = 50;
+    int intervalMs = 200;
+    const char* only = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) Usage();
+        if (strcmp(argv[i], "-n") == 0) samples = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-i") == 0) intervalMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-p") == 0) only = argv[++i];
+        else Usage();
+    }
+    if (samples < 1) Usage();
+
+    SensorProviderList providers;
+    CreatePlatformProviders(providers);
+    providers.erase(std::remove_if(providers.begin(), providers.end(), [only](const std::unique_ptr<SensorProvider>& p) {
+        if (only && strcmp(p->Name(), only) != 0) return true;
+        if (p->Init()) return false;
+        fprintf(stderr, "%s: not available\n", p->Name());
+        return true;
+    }), providers.end());
+    if (providers.empty()) {
+        fprintf(stderr, "no providers to run\n");
+        return 1;
+    }
+
+    printf("sysroot: %s\n", SysRoot().empty() ? "(live)" : SysRoot().c_str());
+    std::vector<ProviderCost> costs(providers.size());
+    ProviderCost pass;
+    ProviderCost socketPass;
+    SensorSnapshot snap;
+    for (int n = 0; n < samples; n++) {
+        if (n > 0 && intervalMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        auto passStart = std::chrono::steady_clock::now();
+        uint64_t passSyscalls = PlatformIoSyscalls();
+        for (size_t i = 0; i < providers.size(); i++) {
+            auto start = std::chrono::steady_clock::now();
+            uint64_t syscalls = PlatformIoSyscalls();
+            providers[i]->Sample(snap);
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            costs[i].totalUs += us;
+            costs[i].maxUs = std::max(costs[i].maxUs, us);
+            costs[i].syscalls += PlatformIoSyscalls() - syscalls;
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - passStart).count();
+        pass.totalUs += us;
+        pass.maxUs = std::max(pass.maxUs, us);
+        pass.syscalls += PlatformIoSyscalls() - passSyscalls;
+        socketPass.totalUs += snap.sockets.scan_us;
+        socketPass.maxUs = std::max(socketPass.maxUs, (double)snap.sockets.scan_us);
+    }
+
+    printf("%-14s %12s %12s %14s\n", "provider", "mean us", "max us", "syscalls/pass");
+    for (size_t i = 0; i < providers.size(); i++) {
+        const ProviderCost& c = costs[i];
+        printf("%-14s %12.1f %12.1f %14.1f\n", providers[i]->Name(), c.totalUs / samples, c.maxUs, (double)c.syscalls / samples);
+    }
+    printf("%-14s %12.1f %12.1f %14.1f\n", "total", pass.totalUs / samples, pass.maxUs, (double)pass.syscalls / samples);
+    printf("%d passes, %.0f ns per pass\n", samples, pass.totalUs * 1000.0 / samples);
+    if (snap.sockets.available) {
+        printf("socket table pass: %u rows, mean %.1f us, max %.1f us (target %.0f us: %s)\n",
+            snap.sockets.scan_rows, socketPass.totalUs / samples, socketPass.maxUs, SOCKET_PASS_TARGET_US,
+            socketPass.maxUs <= SOCKET_PASS_TARGET_US ? "met" : "exceeded");
+    }
+    // Last pass's GPUs, so a stand-in NVML (tools/fake_nvml.c) can be checked end to end.
+    for (const GpuDeviceStats& g : snap.gpus) {
+        printf("gpu%d %s: load %.0f%% temp %.0fC power %.1fW sm %.0fMHz mem %.0fMHz fan %.0f%% pcie %.1f/%.1f MB/s throttle 0x%llx%s\n",
+            g.index, g.name, g.load, g.temp, g.power_w, g.sm_clock_mhz, g.mem_clock_mhz, g.fan_percent,
+            g.pcie_tx_mbps, g.pcie_rx_mbps, g.throttle_reasons, g.throttled ? " (limiting)" : "");
+    }
+    return 0;
+}
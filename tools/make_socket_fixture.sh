@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+# Writes a synthetic /proc/net socket table under <dir> for replaying the socket
+# provider at scale with HWMON_SYSROOT=<dir>:
+#
+#   tools/make_socket_fixture.sh /tmp/sockets-200k          # 200000 TCP rows
+#   tools/make_socket_fixture.sh /tmp/sockets-50k 50000
+#   HWMON_SYSROOT=/tmp/sockets-200k tools/hwmon_bench -p sockets -n 50 -i 0
+#
+# Rows use the kernel's fixed-width tcp4 layout. One in ten goes to a single hot
+# peer and the rest to distinct addresses, so the distinct-peer limit is hit and
+# every lookup past it is a miss: the worst case for the peer table. States and
+# local ports are spread the same way every run (fixed seed). tcp6, udp and udp6
+# get only their headers; snmp gets enough for the rate counters.
+
+set -eu
+
+OUT=${1:?usage: make_socket_fixture.sh <dir> [rows]}
+ROWS=${2:-200000}
+NET="$OUT/proc/net"
+mkdir -p "$NET"
+
+awk -v rows="$ROWS" 'BEGIN {
+    srand(1);
+    print "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode";
+    split("01 01 01 01 01 01 06 08 0A 02", states, " ");
+    split("01BB 0050 1F90 0016 3306", ports, " ");
+    for (i = 0; i < rows; i++) {
+        peer = (i % 10 == 0) ? "0A00000A" : sprintf("%08X", int(rand() * 4294967295));
+        line = sprintf("%4d: 0100007F:%s %s:%04X %s 00000000:00000000 00:00000000 00000000  1000        0 %d 1 0000000000000000 20 4 30 10 -1",
+            i, ports[i % 5 + 1], peer, int(rand() * 65535), states[i % 10 + 1], 100000 + i);
+        printf "%-149s\n", line;
+    }
+}' > "$NET/tcp"
+
+for t in tcp6 udp udp6; do
+    echo "  sl  local_address                         remote_address                        st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode" > "$NET/$t"
+done
+
+cat > "$NET/snmp" <<'EOF'
+Tcp: RtoAlgorithm RtoMin RtoMax MaxConn ActiveOpens PassiveOpens AttemptFails EstabResets CurrEstab InSegs OutSegs RetransSegs InErrs OutRsts InCsumErrors
+Tcp: 1 200 120000 -1 0 0 0 0 0 0 0 0 0 0 0
+Udp: InDatagrams NoPorts InErrors OutDatagrams RcvbufErrors SndbufErrors InCsumErrors IgnoredMulti MemErrors
+Udp: 0 0 0 0 0 0 0 0 0
+EOF
+
+echo "$ROWS rows in $NET/tcp"